@@ -2,6 +2,7 @@
 
 #include <cassert>    // assert
 #include <filesystem> // std::filesystem
+#include <fstream>    // std::ofstream
 #include <vector>     // std::vector
 
 #include <sourcemeta/blaze/foundation.h>
@@ -29,16 +30,22 @@
   }                                                                            \
   BENCHMARK(E2E_Compiler_##name)
 
-#define REGISTER_E2E_EVALUATOR(name, directory_name)                           \
-  static auto E2E_Evaluator_##name(benchmark::State &state)->void {            \
+// Evaluate the tree layout of a template as it comes out of the compiler
+static auto unlinked(sourcemeta::blaze::Template schema_template)
+    -> sourcemeta::blaze::Template {
+  return schema_template;
+}
+
+#define REGISTER_E2E_EVALUATOR_LAYOUT(prefix, layout, name, directory_name)    \
+  static auto E2E_##prefix##_##name(benchmark::State &state)->void {           \
     const std::filesystem::path directory{CURRENT_DIRECTORY                    \
                                           "/e2e/" directory_name};             \
     const auto schema{sourcemeta::core::read_json(directory / "schema.json")}; \
-    const auto schema_template{                                                \
+    const auto schema_template{layout(                                         \
         sourcemeta::blaze::compile(schema, sourcemeta::blaze::schema_walker,   \
                                    sourcemeta::blaze::schema_resolver,         \
                                    sourcemeta::blaze::default_schema_compiler, \
-                                   sourcemeta::blaze::Mode::FastValidation)};  \
+                                   sourcemeta::blaze::Mode::FastValidation))}; \
                                                                                \
     auto stream{sourcemeta::core::read_file(directory / "instances.jsonl")};   \
     std::vector<sourcemeta::core::JSON> instances;                             \
@@ -55,7 +62,66 @@
       }                                                                        \
     }                                                                          \
   }                                                                            \
-  BENCHMARK(E2E_Evaluator_##name)
+  BENCHMARK(E2E_##prefix##_##name)
+
+#define REGISTER_E2E_EVALUATOR(name, directory_name)                           \
+  REGISTER_E2E_EVALUATOR_LAYOUT(Evaluator, unlinked, name, directory_name);    \
+  REGISTER_E2E_EVALUATOR_LAYOUT(Evaluator_Linked, sourcemeta::blaze::link,     \
+                                name, directory_name)
+
+// Compare loading a precompiled template from its JSON and binary forms
+#define REGISTER_E2E_LOADER(name, directory_name)                              \
+  static auto E2E_Loader_JSON_##name(benchmark::State &state)->void {          \
+    const std::filesystem::path directory{CURRENT_DIRECTORY                    \
+                                          "/e2e/" directory_name};             \
+    const auto schema{sourcemeta::core::read_json(directory / "schema.json")}; \
+    const sourcemeta::core::TemporaryDirectory output{                         \
+        std::filesystem::temp_directory_path(), ".blaze-benchmark-"};          \
+    const auto path{output.path() / "template.json"};                          \
+    {                                                                          \
+      std::ofstream stream{path};                                              \
+      sourcemeta::core::stringify(                                             \
+          sourcemeta::blaze::to_json(sourcemeta::blaze::compile(               \
+              schema, sourcemeta::blaze::schema_walker,                        \
+              sourcemeta::blaze::schema_resolver,                              \
+              sourcemeta::blaze::default_schema_compiler,                      \
+              sourcemeta::blaze::Mode::FastValidation)),                       \
+          stream);                                                             \
+    }                                                                          \
+                                                                               \
+    for (auto _ : state) {                                                     \
+      auto schema_template{                                                    \
+          sourcemeta::blaze::from_json(sourcemeta::core::read_json(path))};    \
+      assert(schema_template.has_value());                                     \
+      benchmark::DoNotOptimize(schema_template);                               \
+    }                                                                          \
+  }                                                                            \
+  static auto E2E_Loader_Binary_##name(benchmark::State &state)->void {        \
+    const std::filesystem::path directory{CURRENT_DIRECTORY                    \
+                                          "/e2e/" directory_name};             \
+    const auto schema{sourcemeta::core::read_json(directory / "schema.json")}; \
+    const sourcemeta::core::TemporaryDirectory output{                         \
+        std::filesystem::temp_directory_path(), ".blaze-benchmark-"};          \
+    const auto path{output.path() / "template.bin"};                           \
+    {                                                                          \
+      std::ofstream stream{path, std::ios::binary};                            \
+      sourcemeta::blaze::to_binary(                                            \
+          sourcemeta::blaze::compile(                                          \
+              schema, sourcemeta::blaze::schema_walker,                        \
+              sourcemeta::blaze::schema_resolver,                              \
+              sourcemeta::blaze::default_schema_compiler,                      \
+              sourcemeta::blaze::Mode::FastValidation),                        \
+          stream);                                                             \
+    }                                                                          \
+                                                                               \
+    for (auto _ : state) {                                                     \
+      auto schema_template{sourcemeta::blaze::from_binary(path)};              \
+      assert(schema_template.has_value());                                     \
+      benchmark::DoNotOptimize(schema_template);                               \
+    }                                                                          \
+  }                                                                            \
+  BENCHMARK(E2E_Loader_JSON_##name);                                           \
+  BENCHMARK(E2E_Loader_Binary_##name)
 
 REGISTER_E2E_COMPILER(adaptivecard, "adaptivecard");
 REGISTER_E2E_COMPILER(ansible_meta, "ansible-meta");
@@ -139,3 +205,10 @@ REGISTER_E2E_EVALUATOR(unreal_engine_uproject, "unreal-engine-uproject");
 REGISTER_E2E_EVALUATOR(users_array, "users-array");
 REGISTER_E2E_EVALUATOR(vercel, "vercel");
 REGISTER_E2E_EVALUATOR(yamllint, "yamllint");
+
+REGISTER_E2E_LOADER(adaptivecard, "adaptivecard");
+REGISTER_E2E_LOADER(ansible_meta, "ansible-meta");
+REGISTER_E2E_LOADER(aws_cdk, "aws-cdk");
+REGISTER_E2E_LOADER(krakend, "krakend");
+REGISTER_E2E_LOADER(omc, "omc");
+REGISTER_E2E_LOADER(openapi, "openapi");
@@ -1,7 +1,9 @@
 #include <benchmark/benchmark.h>
 
 #include <cassert>    // assert
+#include <cstdint>    // std::int64_t
 #include <filesystem> // std::filesystem::path
+#include <string>     // std::to_string
 
 #include <sourcemeta/blaze/foundation.h>
 #include <sourcemeta/core/json.h>
@@ -393,6 +395,35 @@ static void Micro_2020_12_Exhaustive_Deep_Numeric_Fail_SimpleOutput(
   }
 }
 
+static void
+Micro_2020_12_Unevaluated_Properties_Large_Object(benchmark::State &state) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "anyOf": [
+      { "patternProperties": { "^key": { "type": "integer" } } },
+      { "required": [ "never" ] }
+    ],
+    "unevaluatedProperties": false
+  })JSON")};
+
+  auto instance{sourcemeta::core::JSON::make_object()};
+  for (std::int64_t index = 0; index < state.range(0); index++) {
+    instance.assign("key" + std::to_string(index),
+                    sourcemeta::core::JSON{index});
+  }
+
+  const auto schema_template{
+      sourcemeta::blaze::compile(schema, sourcemeta::blaze::schema_walker,
+                                 sourcemeta::blaze::schema_resolver,
+                                 sourcemeta::blaze::default_schema_compiler)};
+  sourcemeta::blaze::Evaluator evaluator;
+  for (auto _ : state) {
+    auto result{evaluator.validate(schema_template, instance)};
+    assert(result);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
 BENCHMARK(Micro_2020_12_Dynamic_Ref);
 BENCHMARK(Micro_2020_12_Dynamic_Ref_Single);
 BENCHMARK(Micro_2020_12_Simple_Output_Mask);
@@ -403,3 +434,6 @@ BENCHMARK(Micro_2020_12_Exhaustive_Deep_Numeric_SimpleOutput);
 BENCHMARK(Micro_2020_12_Exhaustive_Deep_Numeric_TraceOutput);
 BENCHMARK(Micro_2020_12_Exhaustive_Deep_Numeric_Fail);
 BENCHMARK(Micro_2020_12_Exhaustive_Deep_Numeric_Fail_SimpleOutput);
+BENCHMARK(Micro_2020_12_Unevaluated_Properties_Large_Object)
+    ->Arg(100)
+    ->Arg(1000);
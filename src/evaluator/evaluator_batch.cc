@@ -0,0 +1,299 @@
+#include <sourcemeta/blaze/evaluator.h>
+
+#include <algorithm> // std::max, std::min
+#include <atomic>    // std::atomic, std::memory_order_relaxed
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // std::size_t
+#include <cstdint>            // std::uint64_t
+#include <exception> // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <memory>       // std::make_unique
+#include <mutex>        // std::mutex, std::lock_guard, std::unique_lock
+#include <span>         // std::span
+#include <stdexcept>    // std::invalid_argument
+#include <system_error> // std::system_error
+#include <thread>       // std::thread
+#include <utility>      // std::pair
+#include <vector>       // std::vector
+
+namespace {
+
+// Validating a small instance takes in the order of hundreds of nanoseconds,
+// so claiming less than this many instances at a time would make contention
+// on the shared cursor dominate the actual work
+constexpr std::size_t MINIMUM_CHUNK{64};
+
+// Guided self-scheduling: every claim takes a share of the remaining work
+// proportional to the number of workers. Chunks start large to keep claims
+// rare, and shrink towards the end so that no worker is left with a long
+// tail while the others are idle
+auto claim(std::atomic<std::size_t> &cursor, const std::size_t size,
+           const std::size_t workers) -> std::pair<std::size_t, std::size_t> {
+  auto begin{cursor.load(std::memory_order_relaxed)};
+  while (begin < size) {
+    const auto remaining{size - begin};
+    const auto chunk{std::max(MINIMUM_CHUNK, remaining / (workers * 2))};
+    const auto end{begin + std::min(chunk, remaining)};
+    if (cursor.compare_exchange_weak(begin, end, std::memory_order_relaxed)) {
+      return {begin, end};
+    }
+  }
+
+  return {size, size};
+}
+
+auto check_sizes(const std::span<const sourcemeta::core::JSON> instances,
+                 const std::span<bool> results) -> void {
+  if (results.size() != instances.size()) {
+    throw std::invalid_argument(
+        "The results span must be as large as the instances span");
+  }
+}
+
+// There is no point in having more workers than chunks to claim
+auto workers_for(const std::size_t parallelism, const std::size_t size)
+    -> std::size_t {
+  return std::min(parallelism, (size + MINIMUM_CHUNK - 1) / MINIMUM_CHUNK);
+}
+
+template <typename Schema>
+auto validate_serial(sourcemeta::blaze::Evaluator &evaluator,
+                     const Schema &schema,
+                     const std::span<const sourcemeta::core::JSON> instances,
+                     const std::span<bool> results) -> bool {
+  bool all_valid{true};
+  for (std::size_t index = 0; index < instances.size(); index++) {
+    results[index] = evaluator.validate(schema, instances[index]);
+    all_valid = all_valid && results[index];
+  }
+
+  return all_valid;
+}
+
+// The work shared by every worker taking part in a batch
+template <typename Schema> struct BatchJob {
+  const Schema &schema;
+  const std::span<const sourcemeta::core::JSON> instances;
+  const std::span<bool> results;
+  const std::size_t workers;
+  std::atomic<std::size_t> cursor{0};
+  std::atomic<bool> all_valid{true};
+  std::exception_ptr exception{nullptr};
+  std::mutex exception_mutex;
+
+  static auto run(void *data, sourcemeta::blaze::Evaluator &evaluator)
+      -> void {
+    auto &job{*static_cast<BatchJob *>(data)};
+    try {
+      bool valid{true};
+      for (auto range{claim(job.cursor, job.instances.size(), job.workers)};
+           range.first < range.second;
+           range = claim(job.cursor, job.instances.size(), job.workers)) {
+        for (auto index = range.first; index < range.second; index++) {
+          job.results[index] =
+              evaluator.validate(job.schema, job.instances[index]);
+          valid = valid && job.results[index];
+        }
+      }
+
+      if (!valid) {
+        job.all_valid.store(false, std::memory_order_relaxed);
+      }
+    } catch (...) {
+      // Stop the other workers from claiming more work
+      job.cursor.store(job.instances.size(), std::memory_order_relaxed);
+      std::lock_guard<std::mutex> lock{job.exception_mutex};
+      if (!job.exception) {
+        job.exception = std::current_exception();
+      }
+    }
+  }
+
+  auto finish() -> bool {
+    if (this->exception) {
+      std::rethrow_exception(this->exception);
+    }
+
+    return this->all_valid.load(std::memory_order_relaxed);
+  }
+};
+
+} // namespace
+
+namespace sourcemeta::blaze {
+
+struct BatchValidator::Internal {
+  // Held for the whole of a batch, so that concurrent batches on the same
+  // pool run one after the other
+  std::mutex batch_mutex;
+  // The calling thread is one of the workers
+  Evaluator evaluator;
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable start;
+  std::condition_variable done;
+  std::uint64_t generation{0};
+  std::size_t active{0};
+  bool stopping{false};
+  void (*run)(void *, Evaluator &){nullptr};
+  void *data{nullptr};
+
+  auto work() -> void {
+    // The evaluator carries mutable state, so every worker needs its own
+    Evaluator worker_evaluator;
+    std::uint64_t seen{0};
+    std::unique_lock<std::mutex> lock{this->mutex};
+    while (true) {
+      this->start.wait(lock, [this, &seen]() -> bool {
+        return this->stopping || this->generation != seen;
+      });
+      if (this->stopping) {
+        return;
+      }
+
+      // A batch only ends once every worker took part in it, so no worker
+      // can miss a generation
+      seen = this->generation;
+      const auto function{this->run};
+      auto *const job{this->data};
+      lock.unlock();
+      function(job, worker_evaluator);
+      lock.lock();
+      this->active -= 1;
+      if (this->active == 0) {
+        this->done.notify_one();
+      }
+    }
+  }
+
+  template <typename Schema>
+  auto validate(const Schema &schema,
+                const std::span<const sourcemeta::core::JSON> instances,
+                const std::span<bool> results) -> bool {
+    check_sizes(instances, results);
+    std::lock_guard<std::mutex> batch_lock{this->batch_mutex};
+    const auto workers{
+        workers_for(this->threads.size() + 1, instances.size())};
+    if (workers <= 1) {
+      return validate_serial(this->evaluator, schema, instances, results);
+    }
+
+    BatchJob<Schema> job{.schema = schema,
+                         .instances = instances,
+                         .results = results,
+                         .workers = workers};
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->run = &BatchJob<Schema>::run;
+      this->data = &job;
+      this->active = this->threads.size();
+      this->generation += 1;
+    }
+
+    // Workers beyond the number of chunks find nothing to claim and go back
+    // to sleep straight away
+    this->start.notify_all();
+    BatchJob<Schema>::run(&job, this->evaluator);
+    {
+      std::unique_lock<std::mutex> lock{this->mutex};
+      this->done.wait(lock, [this]() -> bool { return this->active == 0; });
+    }
+
+    return job.finish();
+  }
+
+  auto stop() -> void {
+    {
+      std::lock_guard<std::mutex> lock{this->mutex};
+      this->stopping = true;
+    }
+
+    this->start.notify_all();
+    for (auto &thread : this->threads) {
+      thread.join();
+    }
+  }
+};
+
+BatchValidator::BatchValidator(std::size_t parallelism)
+    : internal{std::make_unique<Internal>()} {
+  if (parallelism == 0) {
+    parallelism = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  this->internal->threads.reserve(parallelism - 1);
+  for (std::size_t index = 1; index < parallelism; index++) {
+    try {
+      this->internal->threads.emplace_back(
+          [internal = this->internal.get()]() -> void { internal->work(); });
+    } catch (const std::system_error &) {
+      // If we cannot spawn more threads, the ones we have will claim the
+      // remaining work anyway
+      break;
+    }
+  }
+}
+
+BatchValidator::~BatchValidator() {
+  // A moved-from pool has no workers to stop
+  if (this->internal) {
+    this->internal->stop();
+  }
+}
+
+BatchValidator::BatchValidator(BatchValidator &&) noexcept = default;
+
+auto BatchValidator::parallelism() const noexcept -> std::size_t {
+  return this->internal->threads.size() + 1;
+}
+
+auto BatchValidator::validate(
+    const Template &schema,
+    const std::span<const sourcemeta::core::JSON> instances,
+    const std::span<bool> results) -> bool {
+  return this->internal->validate(schema, instances, results);
+}
+
+auto BatchValidator::validate(
+    const LinkedTemplate &schema,
+    const std::span<const sourcemeta::core::JSON> instances,
+    const std::span<bool> results) -> bool {
+  return this->internal->validate(schema, instances, results);
+}
+
+template <typename Schema>
+static auto validate_batch_impl(
+    const Schema &schema,
+    const std::span<const sourcemeta::core::JSON> instances,
+    const std::span<bool> results, std::size_t parallelism) -> bool {
+  check_sizes(instances, results);
+  if (parallelism == 0) {
+    parallelism = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Small batches do not pay for spawning any thread
+  const auto workers{workers_for(parallelism, instances.size())};
+  if (workers <= 1) {
+    Evaluator evaluator;
+    return validate_serial(evaluator, schema, instances, results);
+  }
+
+  BatchValidator pool{workers};
+  return pool.validate(schema, instances, results);
+}
+
+auto validate_batch(const Template &schema,
+                    const std::span<const sourcemeta::core::JSON> instances,
+                    const std::span<bool> results,
+                    const std::size_t parallelism) -> bool {
+  return validate_batch_impl(schema, instances, results, parallelism);
+}
+
+auto validate_batch(const LinkedTemplate &schema,
+                    const std::span<const sourcemeta::core::JSON> instances,
+                    const std::span<bool> results,
+                    const std::size_t parallelism) -> bool {
+  return validate_batch_impl(schema, instances, results, parallelism);
+}
+
+} // namespace sourcemeta::blaze
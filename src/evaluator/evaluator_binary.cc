@@ -0,0 +1,970 @@
+#include <sourcemeta/blaze/evaluator.h>
+
+#include <sourcemeta/core/io.h>
+
+#include <algorithm>   // std::ranges::all_of
+#include <bit>         // std::bit_cast
+#include <cassert>     // assert
+#include <chrono>      // std::chrono::steady_clock
+#include <cstddef>     // std::byte, std::size_t
+#include <cstdint>     // std::uint8_t, std::uint32_t, std::uint64_t
+#include <filesystem>  // std::filesystem::path
+#include <iterator>    // std::size
+#include <limits>      // std::numeric_limits
+#include <optional>    // std::optional, std::nullopt
+#include <sstream>     // std::ostringstream
+#include <string>      // std::string
+#include <string_view> // std::string_view
+#include <type_traits> // std::is_same_v, std::decay_t
+#include <utility>     // std::move, std::to_underlying
+#include <variant>     // std::visit, std::holds_alternative, std::get
+#include <vector>      // std::vector
+
+namespace {
+
+// The ASCII string "BLZT" when read as a little-endian double word
+constexpr std::uint32_t BINARY_MAGIC{0x545A4C42};
+constexpr std::uint32_t FLAG_DYNAMIC{1 << 0};
+constexpr std::uint32_t FLAG_TRACK{1 << 1};
+// Magic, version, flags, reserved, payload size, and checksum
+constexpr std::size_t HEADER_SIZE{4 * 4 + 8 * 2};
+
+// FNV-1a over the payload. We only need to detect truncation and corruption,
+// not tampering, so a cryptographic digest would be wasted work on startup
+auto checksum(const std::uint8_t *data, const std::size_t size)
+    -> std::uint64_t {
+  std::uint64_t result{14695981039346656037ULL};
+  for (std::size_t index = 0; index < size; index++) {
+    result ^= data[index];
+    result *= 1099511628211ULL;
+  }
+
+  return result;
+}
+
+using sourcemeta::core::BinaryReader;
+using sourcemeta::core::BinaryWriter;
+
+// Thrown while loading when the payload is well-formed at the byte level,
+// but does not describe a valid template
+struct BinaryInvalid {};
+
+// Read the size of a sequence, making sure that the payload can hold at least
+// one byte per element before anything is allocated based on it
+auto get_size(BinaryReader &reader) -> std::size_t {
+  const auto size{reader.get_qword()};
+  const auto position{reader.position()};
+  if (size > std::numeric_limits<std::size_t>::max() - position) {
+    throw BinaryInvalid{};
+  }
+
+  reader.seek(position + static_cast<std::size_t>(size));
+  reader.seek(position);
+  return static_cast<std::size_t>(size);
+}
+
+auto put_string(BinaryWriter &writer, const std::string_view value) -> void {
+  writer.put_qword(value.size());
+  writer.put_bytes(reinterpret_cast<const std::byte *>(value.data()),
+                   value.size());
+}
+
+auto get_string(BinaryReader &reader) -> std::string {
+  const auto size{get_size(reader)};
+  std::string result(size, '\0');
+  reader.get_bytes(reinterpret_cast<std::byte *>(result.data()), size);
+  return result;
+}
+
+// Values such as the ones of `const` or `enum` can nest arbitrarily, so we
+// bound the recursion when loading them
+constexpr std::size_t JSON_DEPTH_LIMIT{4096};
+
+// JSON values are persisted in a tagged binary encoding rather than as text,
+// so that loading them does not involve a JSON parser
+auto put_json(BinaryWriter &writer, const sourcemeta::core::JSON &value)
+    -> void {
+  using Type = sourcemeta::core::JSON::Type;
+  writer.put_byte(std::to_underlying(value.type()));
+  switch (value.type()) {
+    case Type::Null:
+      return;
+    case Type::Boolean:
+      writer.put_byte(value.to_boolean() ? 1 : 0);
+      return;
+    case Type::Integer:
+      writer.put_qword(static_cast<std::uint64_t>(value.to_integer()));
+      return;
+    case Type::Real:
+      writer.put_qword(std::bit_cast<std::uint64_t>(value.to_real()));
+      return;
+    case Type::String:
+      put_string(writer, value.to_string());
+      return;
+    case Type::Array:
+      writer.put_qword(value.array_size());
+      for (const auto &item : value.as_array()) {
+        put_json(writer, item);
+      }
+
+      return;
+    case Type::Object:
+      writer.put_qword(value.object_size());
+      for (const auto &entry : value.as_object()) {
+        put_string(writer, entry.first);
+        put_json(writer, entry.second);
+      }
+
+      return;
+    case Type::Decimal:
+      put_string(writer, value.to_decimal().to_string());
+      return;
+  }
+}
+
+auto get_json(BinaryReader &reader, const std::size_t depth = 0)
+    -> sourcemeta::core::JSON {
+  using Type = sourcemeta::core::JSON::Type;
+  if (depth > JSON_DEPTH_LIMIT) {
+    throw BinaryInvalid{};
+  }
+
+  const auto type{reader.get_byte()};
+  switch (type) {
+    case std::to_underlying(Type::Null):
+      return sourcemeta::core::JSON{nullptr};
+    case std::to_underlying(Type::Boolean):
+      return sourcemeta::core::JSON{reader.get_byte() != 0};
+    case std::to_underlying(Type::Integer):
+      return sourcemeta::core::JSON{
+          static_cast<std::int64_t>(reader.get_qword())};
+    case std::to_underlying(Type::Real):
+      return sourcemeta::core::JSON{std::bit_cast<double>(reader.get_qword())};
+    case std::to_underlying(Type::String):
+      return sourcemeta::core::JSON{get_string(reader)};
+    case std::to_underlying(Type::Array): {
+      auto result{sourcemeta::core::JSON::make_array()};
+      const auto size{get_size(reader)};
+      for (std::size_t index = 0; index < size; index++) {
+        result.push_back(get_json(reader, depth + 1));
+      }
+
+      return result;
+    }
+    case std::to_underlying(Type::Object): {
+      auto result{sourcemeta::core::JSON::make_object()};
+      const auto size{get_size(reader)};
+      for (std::size_t index = 0; index < size; index++) {
+        auto key{get_string(reader)};
+        result.assign(std::move(key), get_json(reader, depth + 1));
+      }
+
+      return result;
+    }
+    case std::to_underlying(Type::Decimal):
+      try {
+        return sourcemeta::core::JSON{
+            sourcemeta::core::Decimal{get_string(reader)}};
+      } catch (const sourcemeta::core::DecimalParseError &) {
+        throw BinaryInvalid{};
+      }
+    default:
+      throw BinaryInvalid{};
+  }
+}
+
+auto put_pointer(BinaryWriter &writer, const sourcemeta::core::Pointer &value)
+    -> void {
+  writer.put_qword(value.size());
+  for (const auto &token : value) {
+    if (token.is_property()) {
+      writer.put_byte(0);
+      put_string(writer, token.to_property());
+    } else {
+      writer.put_byte(1);
+      writer.put_qword(token.to_index());
+    }
+  }
+}
+
+auto get_pointer(BinaryReader &reader) -> sourcemeta::core::Pointer {
+  sourcemeta::core::Pointer result;
+  const auto size{get_size(reader)};
+  for (std::uint64_t index = 0; index < size; index++) {
+    if (reader.get_byte() == 0) {
+      result.push_back(get_string(reader));
+    } else {
+      result.push_back(static_cast<std::size_t>(reader.get_qword()));
+    }
+  }
+
+  return result;
+}
+
+auto put_strings(BinaryWriter &writer,
+                 const sourcemeta::blaze::ValueStrings &value) -> void {
+  writer.put_qword(value.size());
+  for (const auto &entry : value) {
+    put_string(writer, entry);
+  }
+}
+
+auto get_strings(BinaryReader &reader) -> sourcemeta::blaze::ValueStrings {
+  sourcemeta::blaze::ValueStrings result;
+  const auto size{get_size(reader)};
+  result.reserve(size);
+  for (std::uint64_t index = 0; index < size; index++) {
+    result.push_back(get_string(reader));
+  }
+
+  return result;
+}
+
+auto put_string_set(BinaryWriter &writer,
+                    const sourcemeta::blaze::ValueStringSet &value) -> void {
+  writer.put_qword(value.size());
+  for (const auto &entry : value) {
+    put_string(writer, entry.first);
+  }
+}
+
+auto get_string_set(BinaryReader &reader)
+    -> sourcemeta::blaze::ValueStringSet {
+  sourcemeta::blaze::ValueStringSet result;
+  const auto size{get_size(reader)};
+  for (std::uint64_t index = 0; index < size; index++) {
+    result.insert(get_string(reader));
+  }
+
+  return result;
+}
+
+auto put_regex(BinaryWriter &writer, const sourcemeta::blaze::ValueRegex &value)
+    -> void {
+  put_string(writer, value.second);
+}
+
+auto get_regex(BinaryReader &reader, std::size_t &regexes)
+    -> sourcemeta::blaze::ValueRegex {
+  auto string{get_string(reader)};
+  auto regex{sourcemeta::core::to_regex(string)};
+  if (!regex.has_value()) {
+    throw BinaryInvalid{};
+  }
+
+  regexes += 1;
+  // NOLINTNEXTLINE(modernize-use-designated-initializers)
+  return {std::move(regex).value(), std::move(string)};
+}
+
+auto put_range(BinaryWriter &writer, const sourcemeta::blaze::ValueRange &value)
+    -> void {
+  writer.put_qword(std::get<0>(value));
+  writer.put_byte(std::get<1>(value).has_value() ? 1 : 0);
+  writer.put_qword(std::get<1>(value).value_or(0));
+  writer.put_byte(std::get<2>(value) ? 1 : 0);
+}
+
+auto get_range(BinaryReader &reader) -> sourcemeta::blaze::ValueRange {
+  const auto minimum{static_cast<std::size_t>(reader.get_qword())};
+  const auto has_maximum{reader.get_byte() != 0};
+  const auto maximum{static_cast<std::size_t>(reader.get_qword())};
+  const auto exhaustive{reader.get_byte() != 0};
+  return {minimum,
+          has_maximum ? std::optional<std::size_t>{maximum} : std::nullopt,
+          exhaustive};
+}
+
+auto put_string_hashes(BinaryWriter &writer,
+                       const sourcemeta::blaze::ValueStringHashes &value)
+    -> void {
+  writer.put_qword(value.first.size());
+  for (const auto &entry : value.first) {
+    put_string(writer, entry.second);
+  }
+
+  writer.put_qword(value.second.size());
+  for (const auto &entry : value.second) {
+    writer.put_qword(entry.first);
+    writer.put_qword(entry.second);
+  }
+}
+
+auto get_string_hashes(BinaryReader &reader)
+    -> sourcemeta::blaze::ValueStringHashes {
+  // Property hashes depend on the hashing implementation in use, so we
+  // recompute them instead of persisting them
+  const sourcemeta::core::PropertyHashJSON<sourcemeta::core::JSON::String>
+      hasher;
+  sourcemeta::blaze::ValueStringHashes result;
+  const auto hashes_size{get_size(reader)};
+  result.first.reserve(hashes_size);
+  for (std::uint64_t index = 0; index < hashes_size; index++) {
+    auto string{get_string(reader)};
+    const auto hash{hasher(string)};
+    result.first.emplace_back(hash, std::move(string));
+  }
+
+  const auto indexes_size{get_size(reader)};
+  result.second.reserve(indexes_size);
+  for (std::uint64_t index = 0; index < indexes_size; index++) {
+    const auto first{static_cast<std::size_t>(reader.get_qword())};
+    const auto second{static_cast<std::size_t>(reader.get_qword())};
+    result.second.emplace_back(first, second);
+  }
+
+  return result;
+}
+
+auto put_value(BinaryWriter &writer, const sourcemeta::blaze::Value &value)
+    -> void {
+  using namespace sourcemeta::blaze;
+  writer.put_byte(static_cast<std::uint8_t>(value.index()));
+  std::visit(
+      [&writer](const auto &variant) -> void {
+        using T = std::decay_t<decltype(variant)>;
+        if constexpr (std::is_same_v<T, ValueNone>) {
+          return;
+        } else if constexpr (std::is_same_v<T, ValueJSON>) {
+          put_json(writer, variant);
+        } else if constexpr (std::is_same_v<T, ValueSet>) {
+          writer.put_qword(variant.size());
+          for (const auto &entry : variant) {
+            put_json(writer, entry);
+          }
+        } else if constexpr (std::is_same_v<T, ValueString>) {
+          put_string(writer, variant);
+        } else if constexpr (std::is_same_v<T, ValueProperty>) {
+          put_string(writer, variant.first);
+        } else if constexpr (std::is_same_v<T, ValueStrings>) {
+          put_strings(writer, variant);
+        } else if constexpr (std::is_same_v<T, ValueStringSet>) {
+          put_string_set(writer, variant);
+        } else if constexpr (std::is_same_v<T, ValueTypes>) {
+          writer.put_byte(static_cast<std::uint8_t>(variant.to_ulong()));
+        } else if constexpr (std::is_same_v<T, ValueType>) {
+          writer.put_byte(std::to_underlying(variant));
+        } else if constexpr (std::is_same_v<T, ValueRegex>) {
+          put_regex(writer, variant);
+        } else if constexpr (std::is_same_v<T, ValueUnsignedInteger>) {
+          writer.put_qword(variant);
+        } else if constexpr (std::is_same_v<T, ValueRange>) {
+          put_range(writer, variant);
+        } else if constexpr (std::is_same_v<T, ValueBoolean>) {
+          writer.put_byte(variant ? 1 : 0);
+        } else if constexpr (std::is_same_v<T, ValueNamedIndexes>) {
+          writer.put_qword(variant.size());
+          for (const auto &entry : variant) {
+            put_string(writer, entry.first);
+            writer.put_qword(entry.second);
+          }
+        } else if constexpr (std::is_same_v<T, ValueStringType>) {
+          writer.put_byte(std::to_underlying(variant));
+        } else if constexpr (std::is_same_v<T, ValueStringMap>) {
+          writer.put_qword(variant.size());
+          for (const auto &entry : variant) {
+            put_string(writer, entry.first);
+            put_strings(writer, entry.second);
+          }
+        } else if constexpr (std::is_same_v<T, ValuePropertyFilter>) {
+          put_string_set(writer, std::get<0>(variant));
+          put_strings(writer, std::get<1>(variant));
+          writer.put_qword(std::get<2>(variant).size());
+          for (const auto &entry : std::get<2>(variant)) {
+            put_regex(writer, entry);
+          }
+        } else if constexpr (std::is_same_v<T, ValueIndexPair>) {
+          writer.put_qword(variant.first);
+          writer.put_qword(variant.second);
+        } else if constexpr (std::is_same_v<T, ValuePointer>) {
+          put_pointer(writer, variant);
+        } else if constexpr (std::is_same_v<T, ValueTypedProperties>) {
+          writer.put_byte(std::to_underlying(variant.first));
+          put_string_set(writer, variant.second);
+        } else if constexpr (std::is_same_v<T, ValueStringHashes>) {
+          put_string_hashes(writer, variant);
+        } else if constexpr (std::is_same_v<T, ValueTypedHashes>) {
+          writer.put_byte(std::to_underlying(variant.first));
+          put_string_hashes(writer, variant.second);
+        } else if constexpr (std::is_same_v<T, ValueIntegerBounds>) {
+          writer.put_qword(static_cast<std::uint64_t>(variant.first));
+          writer.put_qword(static_cast<std::uint64_t>(variant.second));
+        } else if constexpr (std::is_same_v<T, ValueIntegerBoundsWithSize>) {
+          writer.put_qword(static_cast<std::uint64_t>(variant.first.first));
+          writer.put_qword(static_cast<std::uint64_t>(variant.first.second));
+          put_range(writer, variant.second);
+        } else {
+          static_assert(std::is_same_v<T, ValueObjectProperties>);
+          writer.put_qword(variant.size());
+          for (const auto &entry : variant) {
+            put_string(writer, std::get<0>(entry));
+            writer.put_byte(std::get<2>(entry) ? 1 : 0);
+          }
+        }
+      },
+      value);
+}
+
+auto get_type(BinaryReader &reader) -> sourcemeta::core::JSON::Type {
+  const auto type{reader.get_byte()};
+  if (type > std::to_underlying(sourcemeta::core::JSON::Type::Decimal)) {
+    throw BinaryInvalid{};
+  }
+
+  return static_cast<sourcemeta::core::JSON::Type>(type);
+}
+
+auto get_value(BinaryReader &reader, std::size_t &regexes)
+    -> sourcemeta::blaze::Value {
+  using namespace sourcemeta::blaze;
+  const sourcemeta::core::PropertyHashJSON<sourcemeta::core::JSON::String>
+      hasher;
+  switch (reader.get_byte()) {
+    case 0:
+      return ValueNone{};
+    case 1:
+      return get_json(reader);
+    case 2: {
+      ValueSet result;
+      const auto size{get_size(reader)};
+      for (std::uint64_t index = 0; index < size; index++) {
+        result.insert(get_json(reader));
+      }
+
+      return result;
+    }
+    case 3:
+      return get_string(reader);
+    case 4: {
+      auto string{get_string(reader)};
+      const auto hash{hasher(string)};
+      return ValueProperty{std::move(string), hash};
+    }
+    case 5:
+      return get_strings(reader);
+    case 6:
+      return get_string_set(reader);
+    case 7:
+      return ValueTypes{reader.get_byte()};
+    case 8:
+      return get_type(reader);
+    case 9:
+      return get_regex(reader, regexes);
+    case 10:
+      return static_cast<ValueUnsignedInteger>(reader.get_qword());
+    case 11:
+      return get_range(reader);
+    case 12:
+      return ValueBoolean{reader.get_byte() != 0};
+    case 13: {
+      ValueNamedIndexes result;
+      const auto size{get_size(reader)};
+      for (std::uint64_t index = 0; index < size; index++) {
+        auto name{get_string(reader)};
+        result.emplace(std::move(name),
+                       static_cast<ValueUnsignedInteger>(reader.get_qword()));
+      }
+
+      return result;
+    }
+    case 14: {
+      const auto type{reader.get_byte()};
+      if (type > std::to_underlying(ValueStringType::Color)) {
+        throw BinaryInvalid{};
+      }
+
+      return static_cast<ValueStringType>(type);
+    }
+    case 15: {
+      ValueStringMap result;
+      const auto size{get_size(reader)};
+      for (std::uint64_t index = 0; index < size; index++) {
+        auto name{get_string(reader)};
+        result.emplace(std::move(name), get_strings(reader));
+      }
+
+      return result;
+    }
+    case 16: {
+      auto names{get_string_set(reader)};
+      auto prefixes{get_strings(reader)};
+      std::vector<ValueRegex> patterns;
+      const auto size{get_size(reader)};
+      patterns.reserve(size);
+      for (std::uint64_t index = 0; index < size; index++) {
+        patterns.push_back(get_regex(reader, regexes));
+      }
+
+      return ValuePropertyFilter{std::move(names), std::move(prefixes),
+                                 std::move(patterns)};
+    }
+    case 17: {
+      const auto first{static_cast<std::size_t>(reader.get_qword())};
+      const auto second{static_cast<std::size_t>(reader.get_qword())};
+      return ValueIndexPair{first, second};
+    }
+    case 18:
+      return get_pointer(reader);
+    case 19: {
+      const auto type{get_type(reader)};
+      return ValueTypedProperties{type, get_string_set(reader)};
+    }
+    case 20:
+      return get_string_hashes(reader);
+    case 21: {
+      const auto type{get_type(reader)};
+      return ValueTypedHashes{type, get_string_hashes(reader)};
+    }
+    case 22: {
+      const auto minimum{static_cast<std::int64_t>(reader.get_qword())};
+      const auto maximum{static_cast<std::int64_t>(reader.get_qword())};
+      return ValueIntegerBounds{minimum, maximum};
+    }
+    case 23: {
+      const auto minimum{static_cast<std::int64_t>(reader.get_qword())};
+      const auto maximum{static_cast<std::int64_t>(reader.get_qword())};
+      return ValueIntegerBoundsWithSize{{minimum, maximum}, get_range(reader)};
+    }
+    case 24: {
+      ValueObjectProperties result;
+      const auto size{get_size(reader)};
+      result.reserve(size);
+      for (std::uint64_t index = 0; index < size; index++) {
+        auto name{get_string(reader)};
+        const auto hash{hasher(name)};
+        const auto required{reader.get_byte() != 0};
+        result.emplace_back(std::move(name), hash, required);
+      }
+
+      return result;
+    }
+    default:
+      throw BinaryInvalid{};
+  }
+}
+
+// Whether the value of an instruction is of the alternative that its handler
+// assumes, as handlers access their values without checking
+auto has_expected_value(const sourcemeta::blaze::InstructionIndex type,
+                        const sourcemeta::blaze::Value &value) -> bool {
+  using namespace sourcemeta::blaze;
+  switch (type) {
+    case InstructionIndex::AssertionDefines:
+    case InstructionIndex::AssertionDefinesStrict:
+    case InstructionIndex::LogicalWhenDefines:
+    case InstructionIndex::ControlGroupWhenDefines:
+    case InstructionIndex::ControlGroupWhenDefinesDirect:
+      return std::holds_alternative<ValueProperty>(value);
+    case InstructionIndex::AssertionDefinesAll:
+    case InstructionIndex::AssertionDefinesAllStrict:
+    case InstructionIndex::AssertionDefinesExactly:
+    case InstructionIndex::AssertionDefinesExactlyStrict:
+      return std::holds_alternative<ValueStringSet>(value);
+    case InstructionIndex::AssertionDefinesExactlyStrictHash3:
+    case InstructionIndex::AssertionEqualsAnyStringHash:
+      return std::holds_alternative<ValueStringHashes>(value);
+    case InstructionIndex::AssertionPropertyDependencies:
+      return std::holds_alternative<ValueStringMap>(value);
+    case InstructionIndex::AssertionType:
+    case InstructionIndex::AssertionTypeStrict:
+    case InstructionIndex::AssertionPropertyType:
+    case InstructionIndex::AssertionPropertyTypeEvaluate:
+    case InstructionIndex::AssertionPropertyTypeStrict:
+    case InstructionIndex::AssertionPropertyTypeStrictEvaluate:
+    case InstructionIndex::LogicalWhenType:
+    case InstructionIndex::LoopPropertiesType:
+    case InstructionIndex::LoopPropertiesTypeEvaluate:
+    case InstructionIndex::LoopPropertiesTypeStrict:
+    case InstructionIndex::LoopPropertiesTypeStrictEvaluate:
+    case InstructionIndex::LoopItemsType:
+    case InstructionIndex::LoopItemsTypeStrict:
+    case InstructionIndex::ControlGroupWhenType:
+      return std::holds_alternative<ValueType>(value);
+    case InstructionIndex::AssertionTypeAny:
+    case InstructionIndex::AssertionTypeStrictAny:
+    case InstructionIndex::AssertionNotTypeStrictAny:
+    case InstructionIndex::AssertionPropertyTypeStrictAny:
+    case InstructionIndex::AssertionPropertyTypeStrictAnyEvaluate:
+    case InstructionIndex::LoopPropertiesTypeStrictAny:
+    case InstructionIndex::LoopPropertiesTypeStrictAnyEvaluate:
+    case InstructionIndex::LoopItemsTypeStrictAny:
+      return std::holds_alternative<ValueTypes>(value);
+    case InstructionIndex::AssertionTypeStringBounded:
+    case InstructionIndex::AssertionTypeArrayBounded:
+    case InstructionIndex::AssertionTypeObjectBounded:
+    case InstructionIndex::LoopContains:
+      return std::holds_alternative<ValueRange>(value);
+    case InstructionIndex::AssertionTypeStringUpper:
+    case InstructionIndex::AssertionTypeArrayUpper:
+    case InstructionIndex::AssertionTypeObjectUpper:
+    case InstructionIndex::AssertionStringSizeLess:
+    case InstructionIndex::AssertionStringSizeGreater:
+    case InstructionIndex::AssertionArraySizeLess:
+    case InstructionIndex::AssertionArraySizeGreater:
+    case InstructionIndex::AssertionObjectSizeLess:
+    case InstructionIndex::AssertionObjectSizeGreater:
+    case InstructionIndex::LogicalWhenArraySizeGreater:
+    case InstructionIndex::LoopItemsFrom:
+    case InstructionIndex::ControlJump:
+      return std::holds_alternative<ValueUnsignedInteger>(value);
+    case InstructionIndex::AssertionRegex:
+    case InstructionIndex::LoopPropertiesRegex:
+    case InstructionIndex::LoopPropertiesRegexClosed:
+      return std::holds_alternative<ValueRegex>(value);
+    case InstructionIndex::AssertionEqual:
+    case InstructionIndex::AssertionGreaterEqual:
+    case InstructionIndex::AssertionLessEqual:
+    case InstructionIndex::AssertionGreater:
+    case InstructionIndex::AssertionLess:
+    case InstructionIndex::AssertionDivisible:
+    case InstructionIndex::AnnotationEmit:
+    case InstructionIndex::AnnotationToParent:
+      return std::holds_alternative<ValueJSON>(value);
+    case InstructionIndex::AssertionEqualsAny:
+      return std::holds_alternative<ValueSet>(value);
+    case InstructionIndex::AssertionTypeIntegerBounded:
+    case InstructionIndex::AssertionTypeIntegerBoundedStrict:
+    case InstructionIndex::AssertionTypeIntegerLowerBound:
+    case InstructionIndex::AssertionTypeIntegerLowerBoundStrict:
+    case InstructionIndex::LoopItemsIntegerBounded:
+      return std::holds_alternative<ValueIntegerBounds>(value);
+    case InstructionIndex::AssertionStringType:
+      return std::holds_alternative<ValueStringType>(value);
+    case InstructionIndex::AssertionObjectPropertiesSimple:
+      return std::holds_alternative<ValueObjectProperties>(value);
+    case InstructionIndex::LogicalOr:
+    case InstructionIndex::LogicalXor:
+      return std::holds_alternative<ValueBoolean>(value);
+    case InstructionIndex::LogicalCondition:
+      return std::holds_alternative<ValueIndexPair>(value);
+    case InstructionIndex::LoopPropertiesUnevaluatedExcept:
+    case InstructionIndex::LoopPropertiesExcept:
+      return std::holds_alternative<ValuePropertyFilter>(value);
+    case InstructionIndex::LoopPropertiesMatch:
+    case InstructionIndex::LoopPropertiesMatchClosed:
+      return std::holds_alternative<ValueNamedIndexes>(value);
+    case InstructionIndex::LoopPropertiesStartsWith:
+    case InstructionIndex::ControlDynamicAnchorJump:
+      return std::holds_alternative<ValueString>(value);
+    case InstructionIndex::LoopPropertiesExactlyTypeStrict:
+      return std::holds_alternative<ValueTypedProperties>(value);
+    case InstructionIndex::LoopPropertiesExactlyTypeStrictHash:
+    case InstructionIndex::LoopItemsPropertiesExactlyTypeStrictHash:
+    case InstructionIndex::LoopItemsPropertiesExactlyTypeStrictHash3:
+      return std::holds_alternative<ValueTypedHashes>(value);
+    case InstructionIndex::LoopItemsIntegerBoundedSized:
+      return std::holds_alternative<ValueIntegerBoundsWithSize>(value);
+    case InstructionIndex::ControlEvaluate:
+      return std::holds_alternative<ValuePointer>(value);
+    default:
+      // The handler does not read its value
+      return true;
+  }
+}
+
+auto has_valid_hints(const sourcemeta::blaze::ValueStringHashes &value)
+    -> bool {
+  return std::ranges::all_of(value.second, [&value](const auto &hint) -> bool {
+    return (hint.first == 0 && hint.second == 0) ||
+           (hint.first > 0 && hint.first <= hint.second &&
+            hint.second <= value.first.size());
+  });
+}
+
+// Whether the indexes and sizes within the value of an instruction are the
+// ones its handler relies on, as handlers only assert them. The value must be
+// of the expected alternative (see `has_expected_value`)
+auto has_valid_indexes(const sourcemeta::blaze::InstructionIndex type,
+                       const sourcemeta::blaze::Value &value,
+                       const std::size_t children_size,
+                       const std::size_t targets_size) -> bool {
+  using namespace sourcemeta::blaze;
+  switch (type) {
+    case InstructionIndex::ControlJump:
+      return std::get<ValueUnsignedInteger>(value) < targets_size;
+    case InstructionIndex::LogicalCondition: {
+      const auto &indexes{std::get<ValueIndexPair>(value)};
+      return indexes.first <= children_size && indexes.second <= children_size;
+    }
+    case InstructionIndex::LoopPropertiesMatch:
+    case InstructionIndex::LoopPropertiesMatchClosed:
+      return std::ranges::all_of(
+          std::get<ValueNamedIndexes>(value),
+          [children_size](const auto &entry) -> bool {
+            return entry.second < children_size;
+          });
+    case InstructionIndex::AssertionDefinesExactlyStrictHash3:
+      return std::get<ValueStringHashes>(value).first.size() == 3 &&
+             has_valid_hints(std::get<ValueStringHashes>(value));
+    case InstructionIndex::AssertionEqualsAnyStringHash:
+      return has_valid_hints(std::get<ValueStringHashes>(value));
+    case InstructionIndex::LoopPropertiesExactlyTypeStrictHash:
+    case InstructionIndex::LoopItemsPropertiesExactlyTypeStrictHash:
+      return !std::get<ValueTypedHashes>(value).second.first.empty() &&
+             has_valid_hints(std::get<ValueTypedHashes>(value).second);
+    case InstructionIndex::LoopItemsPropertiesExactlyTypeStrictHash3:
+      return std::get<ValueTypedHashes>(value).second.first.size() == 3 &&
+             has_valid_hints(std::get<ValueTypedHashes>(value).second);
+    case InstructionIndex::AssertionObjectPropertiesSimple: {
+      const auto size{std::get<ValueObjectProperties>(value).size()};
+      return size <= 32 && size >= children_size;
+    }
+    case InstructionIndex::AssertionArrayPrefix:
+    case InstructionIndex::AssertionArrayPrefixEvaluate:
+      return children_size > 0;
+    default:
+      return true;
+  }
+}
+
+} // namespace
+
+namespace sourcemeta::blaze {
+
+auto to_binary(const Template &schema, std::ostream &stream) -> void {
+  // The binary form persists the linked layout, so that loading it does not
+  // need to rebuild any instruction tree
+  const auto linked{link(schema)};
+  const auto *base{linked.instructions.data()};
+
+  std::ostringstream payload_stream;
+  BinaryWriter payload{payload_stream};
+  payload.put_qword(linked.targets.size());
+  payload.put_qword(linked.labels.size());
+  payload.put_qword(linked.extra.size());
+  payload.put_qword(linked.instructions.size());
+  payload.put_qword(linked.locations.size());
+
+  for (const auto &target : linked.targets) {
+    payload.put_qword(static_cast<std::uint64_t>(target.data() - base));
+    payload.put_qword(target.size());
+  }
+
+  for (const auto &label : linked.labels) {
+    payload.put_qword(label.first);
+    payload.put_qword(label.second);
+  }
+
+  // Every instruction is a fixed-size record, so that the instruction table
+  // can be walked without decoding any variable-length data
+  for (const auto &instruction : linked.instructions) {
+    payload.put_qword(std::to_underlying(instruction.type));
+    payload.put_qword(instruction.extra_index);
+    payload.put_qword(static_cast<std::uint64_t>(
+        &instruction.relative_instance_location - linked.locations.data()));
+    payload.put_qword(
+        static_cast<std::uint64_t>(instruction.children.data() - base));
+    payload.put_qword(instruction.children.size());
+  }
+
+  for (const auto &location : linked.locations) {
+    put_pointer(payload, location);
+  }
+
+  for (const auto &entry : linked.extra) {
+    payload.put_qword(entry.schema_resource);
+    put_string(payload, entry.keyword_location);
+    put_pointer(payload, entry.relative_schema_location);
+  }
+
+  for (const auto &value : linked.values) {
+    put_value(payload, value);
+  }
+
+  const auto data{payload_stream.str()};
+  BinaryWriter writer{stream};
+  writer.put_dword(BINARY_MAGIC);
+  writer.put_dword(static_cast<std::uint32_t>(BINARY_VERSION));
+  writer.put_dword((linked.dynamic ? FLAG_DYNAMIC : 0) |
+                   (linked.track ? FLAG_TRACK : 0));
+  writer.put_dword(0);
+  writer.put_qword(data.size());
+  writer.put_qword(
+      checksum(reinterpret_cast<const std::uint8_t *>(data.data()),
+               data.size()));
+  writer.put_bytes(reinterpret_cast<const std::byte *>(data.data()),
+                   data.size());
+}
+
+auto from_binary(const std::filesystem::path &path, BinaryLoadCost *cost)
+    -> std::optional<LinkedTemplate> {
+  const auto start{std::chrono::steady_clock::now()};
+  const sourcemeta::core::FileView view{path};
+  // Fixed-size sections, in double words, that must be present
+  constexpr std::size_t COUNTS_SIZE{5 * 8};
+  constexpr std::size_t INSTRUCTION_SIZE{5 * 8};
+  if (view.size() < HEADER_SIZE + COUNTS_SIZE) {
+    return std::nullopt;
+  }
+
+  LinkedTemplate result;
+  std::size_t regexes{0};
+
+  try {
+    BinaryReader reader{view};
+    if (reader.get_dword() != BINARY_MAGIC ||
+        reader.get_dword() != BINARY_VERSION) {
+      return std::nullopt;
+    }
+
+    const auto flags{reader.get_dword()};
+    static_cast<void>(reader.get_dword());
+    const auto payload_size{reader.get_qword()};
+    const auto payload_checksum{reader.get_qword()};
+    assert(reader.position() == HEADER_SIZE);
+    if (payload_size != view.size() - HEADER_SIZE ||
+        checksum(view.as<std::uint8_t>(HEADER_SIZE), payload_size) !=
+            payload_checksum) {
+      return std::nullopt;
+    }
+
+    result.dynamic = (flags & FLAG_DYNAMIC) != 0;
+    result.track = (flags & FLAG_TRACK) != 0;
+
+    const auto targets_size{reader.get_qword()};
+    const auto labels_size{reader.get_qword()};
+    const auto extra_size{reader.get_qword()};
+    const auto instructions_size{reader.get_qword()};
+    const auto locations_size{reader.get_qword()};
+    // Guard against allocating based on counts that the payload cannot hold
+    if (targets_size == 0 || locations_size == 0 ||
+        targets_size > payload_size || labels_size > payload_size ||
+        extra_size > payload_size || locations_size > payload_size ||
+        instructions_size > payload_size / INSTRUCTION_SIZE) {
+      return std::nullopt;
+    }
+
+    std::vector<std::pair<std::size_t, std::size_t>> targets;
+    targets.reserve(targets_size);
+    for (std::uint64_t index = 0; index < targets_size; index++) {
+      const auto offset{static_cast<std::size_t>(reader.get_qword())};
+      const auto size{static_cast<std::size_t>(reader.get_qword())};
+      if (offset > instructions_size || size > instructions_size - offset) {
+        return std::nullopt;
+      }
+
+      targets.emplace_back(offset, size);
+    }
+
+    result.labels.reserve(labels_size);
+    for (std::uint64_t index = 0; index < labels_size; index++) {
+      const auto label{static_cast<std::size_t>(reader.get_qword())};
+      const auto target{static_cast<std::size_t>(reader.get_qword())};
+      if (target >= targets_size) {
+        return std::nullopt;
+      }
+
+      result.labels.emplace_back(label, target);
+    }
+
+    struct Record {
+      InstructionIndex type;
+      std::size_t extra_index;
+      std::size_t location;
+      std::size_t children_offset;
+      std::size_t children_size;
+    };
+
+    std::vector<Record> records;
+    records.reserve(instructions_size);
+    for (std::uint64_t index = 0; index < instructions_size; index++) {
+      const auto type{reader.get_qword()};
+      const auto extra_index{static_cast<std::size_t>(reader.get_qword())};
+      const auto location{static_cast<std::size_t>(reader.get_qword())};
+      const auto children_offset{static_cast<std::size_t>(reader.get_qword())};
+      const auto children_size{static_cast<std::size_t>(reader.get_qword())};
+      if (type >= std::size(InstructionNames) || extra_index >= extra_size ||
+          location >= locations_size || children_offset > instructions_size ||
+          children_size > instructions_size - children_offset) {
+        return std::nullopt;
+      }
+
+      records.push_back({.type = static_cast<InstructionIndex>(type),
+                         .extra_index = extra_index,
+                         .location = location,
+                         .children_offset = children_offset,
+                         .children_size = children_size});
+    }
+
+    result.locations.reserve(locations_size);
+    for (std::uint64_t index = 0; index < locations_size; index++) {
+      result.locations.push_back(get_pointer(reader));
+    }
+
+    result.extra.reserve(extra_size);
+    for (std::uint64_t index = 0; index < extra_size; index++) {
+      const auto schema_resource{static_cast<std::size_t>(reader.get_qword())};
+      auto keyword_location{get_string(reader)};
+      result.extra.push_back(
+          {.relative_schema_location = get_pointer(reader),
+           .keyword_location = std::move(keyword_location),
+           .schema_resource = schema_resource});
+    }
+
+    result.values.reserve(instructions_size);
+    for (std::uint64_t index = 0; index < instructions_size; index++) {
+      result.values.push_back(get_value(reader, regexes));
+    }
+
+    if (reader.has_more_data()) {
+      return std::nullopt;
+    }
+
+    // Handlers trust the values and children of their instructions, so a
+    // file that passes its checksum must still describe a well-formed
+    // template before we evaluate it
+    for (std::size_t index = 0; index < records.size(); index++) {
+      const auto &record{records[index]};
+      const auto &value{result.values[index]};
+      if (!has_expected_value(record.type, value) ||
+          !has_valid_indexes(record.type, value, record.children_size,
+                             targets_size)) {
+        return std::nullopt;
+      }
+
+      if (record.type == InstructionIndex::AssertionArrayPrefix ||
+          record.type == InstructionIndex::AssertionArrayPrefixEvaluate) {
+        for (std::size_t child = 0; child < record.children_size; child++) {
+          if (records[record.children_offset + child].type !=
+              InstructionIndex::ControlGroup) {
+            return std::nullopt;
+          }
+        }
+      }
+    }
+
+    // See `link` on why the instruction table must never re-allocate
+    result.instructions.reserve(instructions_size);
+    const auto *base{result.instructions.data()};
+    for (std::size_t index = 0; index < records.size(); index++) {
+      const auto &record{records[index]};
+      result.instructions.push_back(
+          {.type = record.type,
+           .relative_instance_location = result.locations[record.location],
+           .value = result.values[index],
+           .children = {base + record.children_offset, record.children_size},
+           .extra_index = record.extra_index});
+    }
+
+    result.targets.reserve(targets.size());
+    for (const auto &target : targets) {
+      result.targets.emplace_back(base + target.first, target.second);
+    }
+  } catch (const sourcemeta::core::IOReadOutOfBoundsError &) {
+    return std::nullopt;
+  } catch (const BinaryInvalid &) {
+    return std::nullopt;
+  }
+
+  if (cost) {
+    cost->bytes = view.size();
+    cost->instructions = result.instructions.size();
+    cost->regexes = regexes;
+    cost->duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+  }
+
+  return result;
+}
+
+} // namespace sourcemeta::blaze
@@ -0,0 +1,112 @@
+#include <sourcemeta/blaze/evaluator.h>
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <utility> // std::pair
+#include <vector>  // std::vector
+
+namespace {
+
+// Every instruction of the template, in the final linked order, along with
+// the position at which its own children start in such order
+using Layout = std::vector<
+    std::pair<const sourcemeta::blaze::Instruction *, std::size_t>>;
+
+auto count_instructions(const sourcemeta::blaze::Instructions &instructions)
+    -> std::size_t {
+  std::size_t result{instructions.size()};
+  for (const auto &instruction : instructions) {
+    result += count_instructions(instruction.children);
+  }
+
+  return result;
+}
+
+// Siblings are always contiguous, and the children of every instruction are
+// laid out, along with all of their descendants, before the children of its
+// next sibling, so that the instructions of every subtree stay close together
+auto layout_block(const sourcemeta::blaze::Instructions &instructions,
+                  Layout &layout) -> void {
+  const auto start{layout.size()};
+  for (const auto &instruction : instructions) {
+    layout.emplace_back(&instruction, 0);
+  }
+
+  for (std::size_t index = 0; index < instructions.size(); index++) {
+    layout[start + index].second = layout.size();
+    layout_block(instructions[index].children, layout);
+  }
+}
+
+} // namespace
+
+namespace sourcemeta::blaze {
+
+auto link(const Template &schema) -> LinkedTemplate {
+  LinkedTemplate result;
+  result.dynamic = schema.dynamic;
+  result.track = schema.track;
+  result.labels = schema.labels;
+  result.extra = schema.extra;
+
+  std::size_t total{0};
+  for (const auto &target : schema.targets) {
+    total += count_instructions(target);
+  }
+
+  Layout layout;
+  layout.reserve(total);
+  std::vector<std::size_t> target_offsets;
+  target_offsets.reserve(schema.targets.size());
+  for (const auto &target : schema.targets) {
+    target_offsets.push_back(layout.size());
+    layout_block(target, layout);
+  }
+
+  assert(layout.size() == total);
+
+  // The side tables must be fully populated before creating any instruction,
+  // as instructions refer to their entries by address
+  result.values.reserve(total);
+  // Most instructions apply to the current instance location, so we share a
+  // single empty pointer across all of them
+  result.locations.emplace_back();
+  std::vector<std::size_t> location_indexes;
+  location_indexes.reserve(total);
+  for (const auto &entry : layout) {
+    result.values.push_back(entry.first->value);
+    if (entry.first->relative_instance_location.empty()) {
+      location_indexes.push_back(0);
+    } else {
+      location_indexes.push_back(result.locations.size());
+      result.locations.push_back(entry.first->relative_instance_location);
+    }
+  }
+
+  // Reserving upfront guarantees that the instruction table never
+  // re-allocates, so spans over it remain valid while we populate it
+  result.instructions.reserve(total);
+  const auto *base{result.instructions.data()};
+  for (std::size_t index = 0; index < total; index++) {
+    const auto &instruction{*layout[index].first};
+    result.instructions.push_back(
+        {.type = instruction.type,
+         .relative_instance_location =
+             result.locations[location_indexes[index]],
+         .value = result.values[index],
+         .children = {base + layout[index].second,
+                      instruction.children.size()},
+         .extra_index = instruction.extra_index});
+  }
+
+  assert(result.instructions.data() == base);
+  result.targets.reserve(schema.targets.size());
+  for (std::size_t index = 0; index < schema.targets.size(); index++) {
+    result.targets.emplace_back(base + target_offsets[index],
+                                schema.targets[index].size());
+  }
+
+  return result;
+}
+
+} // namespace sourcemeta::blaze
@@ -0,0 +1,194 @@
+#include <sourcemeta/blaze/evaluator.h>
+
+#include <cassert>   // assert
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uintptr_t
+#include <exception> // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <stdexcept> // std::invalid_argument
+
+// We switch stacks with a handful of instructions of our own rather than with
+// the System V context functions, as `swapcontext` saves and restores the
+// signal mask through a system call on every switch
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#define SOURCEMETA_BLAZE_EVALUATOR_OWNED_STACK
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define SOURCEMETA_BLAZE_EVALUATOR_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SOURCEMETA_BLAZE_EVALUATOR_ASAN
+#endif
+#endif
+
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_OWNED_STACK) &&                         \
+    defined(SOURCEMETA_BLAZE_EVALUATOR_ASAN)
+#include <sanitizer/common_interface_defs.h> // __sanitizer_*_switch_fiber
+#endif
+
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_OWNED_STACK)
+
+// Call the given function with the given argument, with the stack pointer set
+// to the given (16-byte aligned) stack top, and restore the stack pointer of
+// the caller once the function returns. The function must not throw
+extern "C" auto sourcemeta_blaze_evaluator_call_on_stack(
+    void *data, void (*function)(void *), void *stack_top) -> void;
+
+#if defined(__x86_64__)
+// The frame pointer of the caller survives the call as it is callee-saved,
+// and the unwind information describes the frame in terms of it, so
+// debuggers and sanitizers can walk back to the caller stack
+__asm__(".pushsection .text\n"
+        ".p2align 4\n"
+        ".globl sourcemeta_blaze_evaluator_call_on_stack\n"
+        ".hidden sourcemeta_blaze_evaluator_call_on_stack\n"
+        ".type sourcemeta_blaze_evaluator_call_on_stack, @function\n"
+        "sourcemeta_blaze_evaluator_call_on_stack:\n"
+        ".cfi_startproc\n"
+        "  endbr64\n"
+        "  pushq %rbp\n"
+        "  .cfi_def_cfa_offset 16\n"
+        "  .cfi_offset %rbp, -16\n"
+        "  movq %rsp, %rbp\n"
+        "  .cfi_def_cfa_register %rbp\n"
+        "  movq %rdx, %rsp\n"
+        "  callq *%rsi\n"
+        "  movq %rbp, %rsp\n"
+        "  popq %rbp\n"
+        "  .cfi_def_cfa %rsp, 8\n"
+        "  ret\n"
+        ".cfi_endproc\n"
+        ".size sourcemeta_blaze_evaluator_call_on_stack, "
+        ".-sourcemeta_blaze_evaluator_call_on_stack\n"
+        ".popsection\n");
+#elif defined(__aarch64__)
+// Same as above, with the frame record of the caller in x29
+__asm__(".pushsection .text\n"
+        ".p2align 2\n"
+        ".globl sourcemeta_blaze_evaluator_call_on_stack\n"
+        ".hidden sourcemeta_blaze_evaluator_call_on_stack\n"
+        ".type sourcemeta_blaze_evaluator_call_on_stack, %function\n"
+        "sourcemeta_blaze_evaluator_call_on_stack:\n"
+        ".cfi_startproc\n"
+        "  hint #34\n"
+        "  stp x29, x30, [sp, #-16]!\n"
+        "  .cfi_def_cfa_offset 16\n"
+        "  .cfi_offset x29, -16\n"
+        "  .cfi_offset x30, -8\n"
+        "  mov x29, sp\n"
+        "  .cfi_def_cfa_register x29\n"
+        "  mov sp, x2\n"
+        "  blr x1\n"
+        "  mov sp, x29\n"
+        "  .cfi_def_cfa sp, 16\n"
+        "  ldp x29, x30, [sp], #16\n"
+        "  .cfi_def_cfa_offset 0\n"
+        "  .cfi_restore x29\n"
+        "  .cfi_restore x30\n"
+        "  ret\n"
+        ".cfi_endproc\n"
+        ".size sourcemeta_blaze_evaluator_call_on_stack, "
+        ".-sourcemeta_blaze_evaluator_call_on_stack\n"
+        ".popsection\n");
+#endif
+
+#endif
+
+namespace {
+
+// An evaluation aborts with an error once less than this amount of the owned
+// stack remains, leaving room for the deepest handler frame plus whatever the
+// callback or the error handling itself needs
+constexpr std::size_t STACK_SAFETY_MARGIN{128 * 1024};
+
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_OWNED_STACK)
+
+struct StackJob {
+  void (*function)(void *);
+  void *data;
+  std::exception_ptr exception;
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_ASAN)
+  void *fake_stack;
+  const void *caller_bottom;
+  std::size_t caller_size;
+#endif
+};
+
+auto stack_entry(void *data) -> void {
+  auto *job{static_cast<StackJob *>(data)};
+  assert(job);
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_ASAN)
+  __sanitizer_finish_switch_fiber(nullptr, &job->caller_bottom,
+                                  &job->caller_size);
+#endif
+
+  // Exceptions cannot unwind past the bottom of this stack, so we carry
+  // them over to the caller stack ourselves
+  try {
+    job->function(job->data);
+  } catch (...) {
+    job->exception = std::current_exception();
+  }
+
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_ASAN)
+  __sanitizer_start_switch_fiber(nullptr, job->caller_bottom,
+                                 job->caller_size);
+#endif
+}
+
+#endif
+
+} // namespace
+
+namespace sourcemeta::blaze {
+
+Evaluator::Evaluator(const std::size_t stack_size,
+                     const std::size_t maximum_depth)
+    : depth_limit{maximum_depth} {
+  if (stack_size <= STACK_SAFETY_MARGIN) {
+    throw std::invalid_argument(
+        "The evaluation stack must be larger than 128 KiB");
+  }
+
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_OWNED_STACK)
+  this->stack_ = OwnedStack{stack_size};
+#endif
+}
+
+auto Evaluator::run_on_stack(void (*function)(void *), void *data) -> void {
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_OWNED_STACK)
+  assert(this->stack_.data);
+  StackJob job{};
+  job.function = function;
+  job.data = data;
+
+  // Stacks grow downwards, and the ABI requires the stack to be 16-byte
+  // aligned at the point of a call
+  const auto bottom{reinterpret_cast<std::uintptr_t>(this->stack_.data.get())};
+  const auto top{(bottom + this->stack_.size) &
+                 ~static_cast<std::uintptr_t>(15)};
+
+  // A callback might run an evaluation on another evaluator that owns a stack
+  const auto previous_floor{this->stack_floor};
+  this->stack_floor = bottom + STACK_SAFETY_MARGIN;
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_ASAN)
+  __sanitizer_start_switch_fiber(&job.fake_stack, this->stack_.data.get(),
+                                 this->stack_.size);
+#endif
+  sourcemeta_blaze_evaluator_call_on_stack(
+      &job, stack_entry,
+      reinterpret_cast<void *>(top)); // NOLINT(performance-no-int-to-ptr)
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_ASAN)
+  __sanitizer_finish_switch_fiber(job.fake_stack, nullptr, nullptr);
+#endif
+  this->stack_floor = previous_floor;
+
+  if (job.exception) {
+    std::rethrow_exception(job.exception);
+  }
+#else
+  function(data);
+#endif
+}
+
+} // namespace sourcemeta::blaze
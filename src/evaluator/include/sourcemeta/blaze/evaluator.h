@@ -7,20 +7,29 @@
 
 #include <sourcemeta/blaze/evaluator_error.h>
 #include <sourcemeta/blaze/evaluator_instruction.h>
+#include <sourcemeta/blaze/evaluator_mark_set.h>
 
 #include <sourcemeta/core/json.h>
 #include <sourcemeta/core/jsonpointer.h>
 #include <sourcemeta/core/regex.h>
 
-#include <algorithm>   // std::min, std::any_of, std::find
-#include <cassert>     // assert
-#include <cstdint>     // std::uint8_t
-#include <functional>  // std::function
-#include <limits>      // std::numeric_limits
-#include <ranges>      // std::ranges
-#include <string_view> // std::string_view
-#include <utility>     // std::pair
-#include <vector>      // std::vector
+#include <algorithm>     // std::min, std::any_of, std::find
+#include <cassert>       // assert
+#include <chrono>        // std::chrono::nanoseconds
+#include <cstddef>       // std::byte, std::size_t
+#include <cstdint>       // std::uint8_t, std::uintptr_t
+#include <filesystem>    // std::filesystem::path
+#include <functional>    // std::function, std::hash
+#include <limits>        // std::numeric_limits
+#include <memory>        // std::unique_ptr, std::make_unique_for_overwrite
+#include <optional>      // std::optional
+#include <ostream>       // std::ostream
+#include <ranges>        // std::ranges
+#include <span>          // std::span
+#include <string_view>   // std::string_view
+#include <unordered_map> // std::unordered_map
+#include <utility>       // std::pair
+#include <vector>        // std::vector
 
 /// @defgroup evaluator Evaluator
 /// @brief A high-performance JSON Schema evaluator
@@ -51,6 +60,144 @@ constexpr std::size_t JSON_VERSION{5};
 auto SOURCEMETA_BLAZE_EVALUATOR_EXPORT
 from_json(const sourcemeta::core::JSON &json) -> std::optional<Template>;
 
+/// @ingroup evaluator
+/// Represents a compiled schema whose instructions, across all targets, are
+/// laid out in a single contiguous table. Children are spans over such table,
+/// and values and relative instance locations live in side tables. As linked
+/// instructions point into the tables of the linked template that owns them,
+/// a linked template can be moved but not copied.
+///
+/// A linked template can only be evaluated through the callback-free
+/// `Evaluator::validate` overload. Evaluation callbacks, and therefore the
+/// output formatters that rely on them, can only consume a `Template`
+struct LinkedTemplate {
+  LinkedTemplate() = default;
+  LinkedTemplate(const LinkedTemplate &) = delete;
+  auto operator=(const LinkedTemplate &) -> LinkedTemplate & = delete;
+  LinkedTemplate(LinkedTemplate &&) noexcept = default;
+  auto operator=(LinkedTemplate &&) noexcept -> LinkedTemplate & = default;
+  ~LinkedTemplate() = default;
+
+  bool dynamic{false};
+  bool track{false};
+  std::vector<LinkedInstruction> instructions;
+  std::vector<std::span<const LinkedInstruction>> targets;
+  std::vector<std::pair<std::size_t, std::size_t>> labels;
+  std::vector<InstructionExtra> extra;
+  std::vector<Value> values;
+  std::vector<sourcemeta::core::Pointer> locations;
+};
+
+/// @ingroup evaluator
+/// Link a template into its flat and contiguous form, so that evaluation does
+/// not have to chase pointers across scattered allocations. For example:
+///
+/// ```cpp
+/// #include <sourcemeta/blaze/evaluator.h>
+/// #include <sourcemeta/blaze/compiler.h>
+///
+/// #include <sourcemeta/core/json.h>
+/// #include <sourcemeta/blaze/foundation.h>
+///
+/// #include <cassert>
+///
+/// const sourcemeta::core::JSON schema =
+///     sourcemeta::core::parse_json(R"JSON({
+///   "$schema": "https://json-schema.org/draft/2020-12/schema",
+///   "type": "string"
+/// })JSON");
+///
+/// const auto schema_template{sourcemeta::blaze::compile(
+///     schema, sourcemeta::blaze::schema_walker,
+///     sourcemeta::blaze::schema_resolver,
+///     sourcemeta::blaze::default_schema_compiler)};
+///
+/// const auto linked_template{sourcemeta::blaze::link(schema_template)};
+///
+/// sourcemeta::blaze::Evaluator evaluator;
+/// const sourcemeta::core::JSON instance{"foo bar"};
+/// assert(evaluator.validate(linked_template, instance));
+/// ```
+auto SOURCEMETA_BLAZE_EVALUATOR_EXPORT link(const Template &schema)
+    -> LinkedTemplate;
+
+/// @ingroup evaluator
+constexpr std::size_t BINARY_VERSION{2};
+
+/// @ingroup evaluator
+/// Serialise a template into its binary form. The binary form persists the
+/// linked layout of the template (see `link`) behind a versioned header and a
+/// payload checksum. For example:
+///
+/// ```cpp
+/// #include <sourcemeta/blaze/evaluator.h>
+/// #include <sourcemeta/blaze/compiler.h>
+///
+/// #include <sourcemeta/core/json.h>
+/// #include <sourcemeta/blaze/foundation.h>
+///
+/// #include <fstream>
+///
+/// const sourcemeta::core::JSON schema =
+///     sourcemeta::core::parse_json(R"JSON({
+///   "$schema": "https://json-schema.org/draft/2020-12/schema",
+///   "type": "string"
+/// })JSON");
+///
+/// const auto schema_template{sourcemeta::blaze::compile(
+///     schema, sourcemeta::blaze::schema_walker,
+///     sourcemeta::blaze::schema_resolver,
+///     sourcemeta::blaze::default_schema_compiler)};
+///
+/// std::ofstream stream{"template.bin", std::ios::binary};
+/// sourcemeta::blaze::to_binary(schema_template, stream);
+/// ```
+auto SOURCEMETA_BLAZE_EVALUATOR_EXPORT to_binary(const Template &schema,
+                                                 std::ostream &stream) -> void;
+
+/// @ingroup evaluator
+/// Describes the work performed while loading a binary template
+struct BinaryLoadCost {
+  /// The size of the binary template file
+  std::size_t bytes;
+  /// The number of instructions across all targets
+  std::size_t instructions;
+  /// The number of regular expressions that had to be compiled
+  std::size_t regexes;
+  /// The wall-clock time spent loading the binary template
+  std::chrono::nanoseconds duration;
+};
+
+/// @ingroup evaluator
+/// Load a binary template (see `to_binary`) by memory-mapping the given file.
+/// The instruction table is loaded as it is, without rebuilding any
+/// instruction tree, and JSON values are decoded from a binary encoding
+/// without parsing any JSON text. If the file is not a valid binary template,
+/// or it was written by an incompatible version of Blaze, or its checksum does
+/// not match, this function returns no result. The checksum only detects
+/// corruption, so the loader also rejects files whose instructions carry
+/// values of a kind their evaluation does not expect, or indexes (such as jump
+/// targets) that are out of range. If passed, the cost structure is populated
+/// on success. For example:
+///
+/// ```cpp
+/// #include <sourcemeta/blaze/evaluator.h>
+///
+/// #include <cassert>
+///
+/// sourcemeta::blaze::BinaryLoadCost cost;
+/// const auto linked_template{
+///     sourcemeta::blaze::from_binary("template.bin", &cost)};
+/// assert(linked_template.has_value());
+///
+/// sourcemeta::blaze::Evaluator evaluator;
+/// const sourcemeta::core::JSON instance{"foo bar"};
+/// assert(evaluator.validate(linked_template.value(), instance));
+/// ```
+auto SOURCEMETA_BLAZE_EVALUATOR_EXPORT
+from_binary(const std::filesystem::path &path, BinaryLoadCost *cost = nullptr)
+    -> std::optional<LinkedTemplate>;
+
 /// @ingroup evaluator
 /// Represents the state of an instruction evaluation
 enum class EvaluationType : std::uint8_t { Pre, Post };
@@ -78,6 +225,38 @@ using Callback = std::function<void(
 /// @ingroup evaluator
 class SOURCEMETA_BLAZE_EVALUATOR_EXPORT Evaluator {
 public:
+  /// Create an evaluator that evaluates on the native stack of the calling
+  /// thread, up to a fixed evaluation depth
+  Evaluator() = default;
+
+  /// Create an evaluator that evaluates on a heap-allocated stack of the given
+  /// size in bytes, owned by the evaluator and reused across evaluations,
+  /// rather than on the native stack of the calling thread. The evaluation
+  /// depth is then bounded by the given maximum depth and by the size of such
+  /// stack, and exceeding either results in an evaluation error. For
+  /// example:
+  ///
+  /// ```cpp
+  /// #include <sourcemeta/blaze/evaluator.h>
+  ///
+  /// // Evaluate on a 64 MiB stack, without limiting the evaluation depth
+  /// sourcemeta::blaze::Evaluator evaluator{64 * 1024 * 1024};
+  /// ```
+  ///
+  /// The stack size must be larger than 128 KiB, as that much of the stack is
+  /// reserved for error handling and for any evaluation callback. Otherwise,
+  /// this constructor throws `std::invalid_argument`.
+  ///
+  /// Switching stacks costs a handful of instructions on every evaluation,
+  /// and does not involve system calls. Copying an evaluator that owns a stack
+  /// allocates a new stack of the same size for the copy. On platforms that
+  /// do not support switching stacks (currently anything other than Linux on
+  /// x86-64 or AArch64), the evaluator evaluates on the native stack, up to
+  /// the given maximum depth.
+  explicit Evaluator(
+      std::size_t stack_size,
+      std::size_t maximum_depth = std::numeric_limits<std::size_t>::max());
+
   /// This function evaluates a schema compiler template, returning a boolean
   /// without error information. For example:
   ///
@@ -108,22 +287,24 @@ public:
   /// ```
   inline auto validate(const Template &schema,
                        const sourcemeta::core::JSON &instance) -> bool {
-    assert(this->evaluate_path.empty());
-    assert(this->instance_location.empty());
-    assert(this->resources.empty());
+    if (this->stack_.data) [[unlikely]] {
+      return this->on_stack(
+          [&]() -> bool { return this->validate_fast(schema, instance); });
+    }
 
-    if (schema.track && schema.dynamic) [[unlikely]] {
-      this->evaluated_.clear();
-      return this->evaluate_impl<true, true, false>(schema, instance, nullptr);
-    } else if (schema.track) [[unlikely]] {
-      this->evaluated_.clear();
-      return this->evaluate_impl<true, false, false>(schema, instance, nullptr);
-    } else if (schema.dynamic) [[unlikely]] {
-      return this->evaluate_impl<false, true, false>(schema, instance, nullptr);
-    } else {
-      return this->evaluate_impl<false, false, false>(schema, instance,
-                                                      nullptr);
+    return this->validate_fast(schema, instance);
+  }
+
+  /// This function evaluates a linked schema compiler template (see `link`),
+  /// returning a boolean without error information.
+  inline auto validate(const LinkedTemplate &schema,
+                       const sourcemeta::core::JSON &instance) -> bool {
+    if (this->stack_.data) [[unlikely]] {
+      return this->on_stack(
+          [&]() -> bool { return this->validate_fast(schema, instance); });
     }
+
+    return this->validate_fast(schema, instance);
   }
 
   /// This method evaluates a schema compiler template, executing the given
@@ -180,16 +361,62 @@ public:
   inline auto validate(const Template &schema,
                        const sourcemeta::core::JSON &instance,
                        const Callback &callback) -> bool {
+    if (this->stack_.data) [[unlikely]] {
+      return this->on_stack([&]() -> bool {
+        return this->validate_callback(schema, instance, callback);
+      });
+    }
+
+    return this->validate_callback(schema, instance, callback);
+  }
+
+#ifndef DOXYGEN
+  template <typename Schema>
+  inline auto validate_fast(const Schema &schema,
+                            const sourcemeta::core::JSON &instance) -> bool {
     assert(this->evaluate_path.empty());
     assert(this->instance_location.empty());
     assert(this->resources.empty());
-    this->evaluated_.clear();
+
+    if (schema.track && schema.dynamic) [[unlikely]] {
+      this->clear_evaluated();
+      return this->evaluate_impl<true, true, false>(schema, instance, nullptr);
+    } else if (schema.track) [[unlikely]] {
+      this->clear_evaluated();
+      return this->evaluate_impl<true, false, false>(schema, instance, nullptr);
+    } else if (schema.dynamic) [[unlikely]] {
+      return this->evaluate_impl<false, true, false>(schema, instance, nullptr);
+    } else {
+      return this->evaluate_impl<false, false, false>(schema, instance,
+                                                      nullptr);
+    }
+  }
+
+  inline auto validate_callback(const Template &schema,
+                                const sourcemeta::core::JSON &instance,
+                                const Callback &callback) -> bool {
+    assert(this->evaluate_path.empty());
+    assert(this->instance_location.empty());
+    assert(this->resources.empty());
+    this->clear_evaluated();
     return this->evaluate_impl<true, true, true>(schema, instance, &callback);
   }
 
-#ifndef DOXYGEN
-  template <bool Track, bool Dynamic, bool HasCallback>
-  auto evaluate_impl(const Template &schema,
+  // Run the given function on the stack owned by this evaluator, propagating
+  // any exception it throws
+  auto run_on_stack(void (*function)(void *), void *data) -> void;
+
+  template <typename Function> auto on_stack(const Function &function) -> bool {
+    bool result{false};
+    auto thunk{[&function, &result]() -> void { result = function(); }};
+    using Thunk = decltype(thunk);
+    this->run_on_stack(
+        [](void *data) -> void { (*static_cast<Thunk *>(data))(); }, &thunk);
+    return result;
+  }
+
+  template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
+  auto evaluate_impl(const Schema &schema,
                      const sourcemeta::core::JSON &instance,
                      const Callback *callback) -> bool;
 
@@ -214,32 +441,54 @@ public:
     return (resource + result) & mask;
   }
 
+  // Mark the given instance location as evaluated by the current evaluate
+  // path. The mark is recorded against every prefix of the evaluate path, from
+  // the longest to the shortest. Marks are only ever dropped in the reverse
+  // order in which they were recorded (see `unevaluate`), so once a prefix
+  // already holds a mark for the instance, all the shorter ones do too
   auto evaluate(const sourcemeta::core::JSON *target) -> void {
-    Evaluation mark{.instance = target,
-                    .evaluate_path = this->evaluate_path,
-                    .skip = false};
-    this->evaluated_.push_back(std::move(mark));
+    this->enter_scopes();
+    for (auto index = this->scopes_.size(); index > 0; index--) {
+      if (!this->mark(target, this->scopes_[index - 1])) {
+        return;
+      }
+    }
+
+    this->mark(target, ROOT_SCOPE);
   }
 
-  [[nodiscard]] auto is_evaluated(const sourcemeta::core::JSON *target) const
+  // Whether the given instance location was marked as evaluated by an evaluate
+  // path that starts with the current one minus its last token (the keyword
+  // being evaluated). This is a single lookup, no matter how many marks exist
+  [[nodiscard]] auto is_evaluated(const sourcemeta::core::JSON *target)
       -> bool {
-    // NOLINTNEXTLINE(modernize-loop-convert)
-    for (auto iterator = this->evaluated_.rbegin();
-         iterator != this->evaluated_.rend(); ++iterator) {
-      if (target == iterator->instance && !iterator->skip &&
-          iterator->evaluate_path.starts_with_initial(this->evaluate_path)) {
-        return true;
-      }
+    if (this->evaluate_path.size() <= 1) {
+      return this->evaluated_.contains({target, ROOT_SCOPE});
     }
 
-    return false;
+    this->enter_scopes();
+    return this->evaluated_.contains(
+        {target, this->scopes_[this->evaluate_path.size() - 2]});
   }
 
-  auto unevaluate() -> void {
-    for (auto &entry : this->evaluated_) {
-      if (!entry.skip && entry.evaluate_path.starts_with(this->evaluate_path)) {
-        entry.skip = true;
-      }
+  // Drop the marks recorded since the given checkpoint (the size of the mark
+  // log). A `not` takes a checkpoint before evaluating its subschema, so the
+  // marks recorded since then are exactly the ones whose evaluate path starts
+  // with the evaluate path of the `not`. The ones recorded before it cannot,
+  // as any earlier evaluation of the same evaluate path dropped its own marks
+  // when it finished
+  auto unevaluate(const std::size_t checkpoint) -> void {
+    assert(checkpoint <= this->evaluated_log_.size());
+    while (this->evaluated_log_.size() > checkpoint) {
+      this->evaluated_.erase(this->evaluated_log_.back());
+      this->evaluated_log_.pop_back();
+    }
+  }
+
+  // Forget the scopes of evaluate path tokens that are no longer there
+  auto leave_scopes() noexcept -> void {
+    if (this->scopes_.size() > this->evaluate_path.size()) {
+      this->scopes_.resize(this->evaluate_path.size());
     }
   }
 
@@ -250,31 +499,258 @@ public:
   sourcemeta::core::WeakPointer instance_location;
   std::vector<std::size_t> resources;
 
-  struct Evaluation {
-    const sourcemeta::core::JSON *instance;
-    sourcemeta::core::WeakPointer evaluate_path;
-    bool skip;
+  // Every distinct prefix of an evaluate path is interned into a scope
+  // identifier, so that comparing two prefixes is comparing two integers. The
+  // scope of the empty prefix is always zero
+  static constexpr std::size_t ROOT_SCOPE{0};
+
+  struct Scope {
+    std::size_t parent;
+    sourcemeta::core::WeakPointer::Token token;
+    auto operator==(const Scope &) const noexcept -> bool = default;
+  };
+
+  struct ScopeHash {
+    auto operator()(const Scope &scope) const noexcept -> std::size_t {
+      const auto token_hash{
+          scope.token.is_property()
+              ? std::hash<std::string_view>{}(scope.token.to_property())
+              : scope.token.to_index()};
+      return scope.parent * 31 + token_hash;
+    }
   };
 
-  std::vector<Evaluation> evaluated_;
+  // The scope of every prefix of the current evaluate path, computed on
+  // demand. The entry at index N is the scope of the first N + 1 tokens
+  std::vector<std::size_t> scopes_;
+  std::unordered_map<Scope, std::size_t, ScopeHash> scope_ids_;
+  // The instance locations marked as evaluated under every scope, along with
+  // the order in which the marks were recorded, so that they can be dropped
+  MarkSet evaluated_;
+  std::vector<MarkSet::value_type> evaluated_log_;
+
+  auto enter_scopes() -> void {
+    while (this->scopes_.size() < this->evaluate_path.size()) {
+      const auto parent{this->scopes_.empty() ? ROOT_SCOPE
+                                              : this->scopes_.back()};
+      const auto [match, inserted] = this->scope_ids_.try_emplace(
+          {.parent = parent,
+           .token = this->evaluate_path.at(this->scopes_.size())},
+          this->scope_ids_.size() + 1);
+      this->scopes_.push_back(match->second);
+    }
+  }
+
+  auto mark(const sourcemeta::core::JSON *target, const std::size_t scope)
+      -> bool {
+    const auto inserted{this->evaluated_.insert({target, scope})};
+    if (inserted) {
+      this->evaluated_log_.emplace_back(target, scope);
+    }
+
+    return inserted;
+  }
+
+  auto clear_evaluated() -> void {
+    // The tokens of the interned scopes point into the previous template
+    this->scopes_.clear();
+    this->scope_ids_.clear();
+    this->evaluated_.clear();
+    this->evaluated_log_.clear();
+  }
+
+  // The maximum depth of the instruction tree that an evaluation may reach
+  std::size_t depth_limit{300};
+  // When evaluating on an owned stack, the lowest frame address at which an
+  // evaluation may keep going. Stacks grow downwards on every platform where
+  // we support owned stacks, so this is zero otherwise
+  std::uintptr_t stack_floor{0};
+
+  // A stack that is copied by allocating a new stack of the same size, as no
+  // two evaluators can evaluate on the same stack
+  struct OwnedStack {
+    OwnedStack() = default;
+    explicit OwnedStack(const std::size_t stack_size)
+        : data{std::make_unique_for_overwrite<std::byte[]>(stack_size)},
+          size{stack_size} {}
+    OwnedStack(const OwnedStack &other) : OwnedStack{} {
+      *this = other;
+    }
+    auto operator=(const OwnedStack &other) -> OwnedStack & {
+      if (this != &other) {
+        this->data = other.data
+                         ? std::make_unique_for_overwrite<std::byte[]>(
+                               other.size)
+                         : nullptr;
+        this->size = other.size;
+      }
+
+      return *this;
+    }
+    OwnedStack(OwnedStack &&) noexcept = default;
+    auto operator=(OwnedStack &&) noexcept -> OwnedStack & = default;
+    ~OwnedStack() = default;
+
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size{0};
+  };
+
+  OwnedStack stack_;
 #if defined(_MSC_VER)
 #pragma warning(default : 4251 4275)
 #endif
 #endif
 };
 
+/// @ingroup evaluator
+/// Validate many instances against the same template in parallel, writing
+/// whether each instance is valid to the corresponding index of the results
+/// span, and returning whether every instance is valid. Every thread evaluates
+/// with its own evaluator and claims instances in chunks that shrink as the
+/// remaining work decreases, so the template can be shared without locking.
+/// If the parallelism is set to zero, the function will run using the
+/// available number of cores. The results span must be as large as the
+/// instances span, otherwise this function throws `std::invalid_argument`.
+/// To validate many batches, prefer `BatchValidator`, which reuses its
+/// threads across batches. For example:
+///
+/// ```cpp
+/// #include <sourcemeta/blaze/evaluator.h>
+/// #include <sourcemeta/blaze/compiler.h>
+///
+/// #include <sourcemeta/core/json.h>
+/// #include <sourcemeta/blaze/foundation.h>
+///
+/// #include <array>
+/// #include <cassert>
+///
+/// const sourcemeta::core::JSON schema =
+///     sourcemeta::core::parse_json(R"JSON({
+///   "$schema": "https://json-schema.org/draft/2020-12/schema",
+///   "type": "string"
+/// })JSON");
+///
+/// const auto schema_template{sourcemeta::blaze::compile(
+///     schema, sourcemeta::blaze::schema_walker,
+///     sourcemeta::blaze::schema_resolver,
+///     sourcemeta::blaze::default_schema_compiler)};
+///
+/// const std::array<sourcemeta::core::JSON, 3> instances{
+///     sourcemeta::core::JSON{"foo"}, sourcemeta::core::JSON{1},
+///     sourcemeta::core::JSON{"bar"}};
+/// std::array<bool, 3> results;
+///
+/// const auto all_valid{sourcemeta::blaze::validate_batch(
+///     schema_template, instances, results)};
+/// assert(!all_valid);
+/// assert(results[0]);
+/// assert(!results[1]);
+/// assert(results[2]);
+/// ```
+auto SOURCEMETA_BLAZE_EVALUATOR_EXPORT
+validate_batch(const Template &schema,
+               std::span<const sourcemeta::core::JSON> instances,
+               std::span<bool> results, std::size_t parallelism = 0) -> bool;
+
+/// @ingroup evaluator
+/// Validate many instances against the same linked template (see `link`) in
+/// parallel. See the `Template` overload for details.
+auto SOURCEMETA_BLAZE_EVALUATOR_EXPORT
+validate_batch(const LinkedTemplate &schema,
+               std::span<const sourcemeta::core::JSON> instances,
+               std::span<bool> results, std::size_t parallelism = 0) -> bool;
+
+/// @ingroup evaluator
+/// A pool of worker threads, each with its own evaluator, that validates
+/// batches of instances in the same way as `validate_batch`. Unlike
+/// `validate_batch`, which spawns and joins its threads on every call, the
+/// pool keeps its threads and evaluators across batches, so it suits
+/// validating many small batches at a high rate. Small batches are validated
+/// on the calling thread without waking any worker. Batches submitted
+/// concurrently to the same pool run one after the other. If the parallelism
+/// is set to zero, the pool will use the available number of cores, counting
+/// the calling thread. For example:
+///
+/// ```cpp
+/// #include <sourcemeta/blaze/evaluator.h>
+/// #include <sourcemeta/blaze/compiler.h>
+///
+/// #include <sourcemeta/core/json.h>
+/// #include <sourcemeta/blaze/foundation.h>
+///
+/// #include <array>
+/// #include <cassert>
+///
+/// const sourcemeta::core::JSON schema =
+///     sourcemeta::core::parse_json(R"JSON({
+///   "$schema": "https://json-schema.org/draft/2020-12/schema",
+///   "type": "string"
+/// })JSON");
+///
+/// const auto schema_template{sourcemeta::blaze::compile(
+///     schema, sourcemeta::blaze::schema_walker,
+///     sourcemeta::blaze::schema_resolver,
+///     sourcemeta::blaze::default_schema_compiler)};
+///
+/// sourcemeta::blaze::BatchValidator pool;
+///
+/// const std::array<sourcemeta::core::JSON, 2> instances{
+///     sourcemeta::core::JSON{"foo"}, sourcemeta::core::JSON{"bar"}};
+/// std::array<bool, 2> results;
+/// assert(pool.validate(schema_template, instances, results));
+/// ```
+class SOURCEMETA_BLAZE_EVALUATOR_EXPORT BatchValidator {
+public:
+  explicit BatchValidator(std::size_t parallelism = 0);
+  ~BatchValidator();
+  BatchValidator(const BatchValidator &) = delete;
+  auto operator=(const BatchValidator &) -> BatchValidator & = delete;
+  BatchValidator(BatchValidator &&) noexcept;
+  auto operator=(BatchValidator &&) -> BatchValidator & = delete;
+
+  /// Validate a batch of instances against a template, writing whether each
+  /// instance is valid to the corresponding index of the results span, and
+  /// returning whether every instance is valid. The results span must be as
+  /// large as the instances span, otherwise this method throws
+  /// `std::invalid_argument`. If the evaluation of any instance throws, the
+  /// batch stops and the first such exception is rethrown
+  auto validate(const Template &schema,
+                std::span<const sourcemeta::core::JSON> instances,
+                std::span<bool> results) -> bool;
+
+  /// Validate a batch of instances against a linked template (see `link`).
+  /// See the `Template` overload for details
+  auto validate(const LinkedTemplate &schema,
+                std::span<const sourcemeta::core::JSON> instances,
+                std::span<bool> results) -> bool;
+
+  /// The number of threads that take part in a batch, including the calling
+  /// thread
+  [[nodiscard]] auto parallelism() const noexcept -> std::size_t;
+
+private:
+  struct Internal;
+#if defined(_MSC_VER)
+#pragma warning(disable : 4251)
+#endif
+  std::unique_ptr<Internal> internal;
+#if defined(_MSC_VER)
+#pragma warning(default : 4251)
+#endif
+};
+
 } // namespace sourcemeta::blaze
 
 #ifndef DOXYGEN
 
 #include <sourcemeta/blaze/evaluator_dispatch.h>
 
-template <bool Track, bool Dynamic, bool HasCallback>
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
 auto sourcemeta::blaze::Evaluator::evaluate_impl(
-    const Template &schema, const sourcemeta::core::JSON &instance,
+    const Schema &schema, const sourcemeta::core::JSON &instance,
     const Callback *callback) -> bool {
   assert(!schema.targets.empty());
-  dispatch::DispatchContext<Track, Dynamic, HasCallback> context{
+  dispatch::DispatchContext<Track, Dynamic, HasCallback, Schema> context{
       .schema = &schema,
       .callback = callback,
       .evaluator = this,
@@ -58,6 +58,7 @@
     context.evaluator->evaluate_path.pop_back(                                 \
         context.schema->extra[instruction.extra_index]                         \
             .relative_schema_location.size());                                 \
+    context.evaluator->leave_scopes();                                         \
   }                                                                            \
   if constexpr (HasCallback) {                                                 \
     context.evaluator->instance_location.pop_back(                             \
@@ -176,6 +177,7 @@
     context.evaluator->evaluate_path.pop_back(                                 \
         context.schema->extra[instruction.extra_index]                         \
             .relative_schema_location.size());                                 \
+    context.evaluator->leave_scopes();                                         \
     context.evaluator->instance_location.pop_back(                             \
         instruction.relative_instance_location.size());                        \
   }                                                                            \
@@ -252,36 +254,47 @@ inline auto assume_value_copy(const Value &variant) noexcept -> T {
   return *pointer;
 }
 
-template <bool Track, bool Dynamic, bool HasCallback> struct DispatchContext {
-  const sourcemeta::blaze::Template *schema;
+// The instruction type that a given template type consists of
+template <typename Schema> struct SchemaTraits;
+template <> struct SchemaTraits<sourcemeta::blaze::Template> {
+  using Instruction = sourcemeta::blaze::Instruction;
+};
+template <> struct SchemaTraits<sourcemeta::blaze::LinkedTemplate> {
+  using Instruction = sourcemeta::blaze::LinkedInstruction;
+};
+
+template <typename Schema>
+using SchemaInstruction = typename SchemaTraits<Schema>::Instruction;
+
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
+struct DispatchContext {
+  const Schema *schema;
   const sourcemeta::blaze::Callback *callback;
   sourcemeta::blaze::Evaluator *evaluator;
   const sourcemeta::core::JSON::String *property_target;
 };
 
-template <bool Track, bool Dynamic, bool HasCallback>
-inline auto
-evaluate_instruction(const sourcemeta::blaze::Instruction &instruction,
-                     const sourcemeta::core::JSON &instance,
-                     const std::uint64_t depth,
-                     DispatchContext<Track, Dynamic, HasCallback> &context)
-    -> bool;
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
+inline auto evaluate_instruction(
+    const SchemaInstruction<Schema> &instruction,
+    const sourcemeta::core::JSON &instance, const std::uint64_t depth,
+    DispatchContext<Track, Dynamic, HasCallback, Schema> &context) -> bool;
 
-template <bool Track, bool Dynamic, bool HasCallback>
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
 inline auto evaluate_instruction_with_property(
-    const sourcemeta::blaze::Instruction &instruction,
+    const SchemaInstruction<Schema> &instruction,
     const sourcemeta::core::JSON &instance, const std::uint64_t depth,
-    DispatchContext<Track, Dynamic, HasCallback> &context,
+    DispatchContext<Track, Dynamic, HasCallback, Schema> &context,
     const sourcemeta::core::JSON::String &name) -> bool;
 
 #define INSTRUCTION_HANDLER(name)                                              \
-  template <bool Track, bool Dynamic, bool HasCallback>                        \
+  template <bool Track, bool Dynamic, bool HasCallback, typename Schema>       \
   static inline auto name(                                                     \
-      [[maybe_unused]] const sourcemeta::blaze::Instruction &instruction,      \
+      [[maybe_unused]] const SchemaInstruction<Schema> &instruction,           \
       [[maybe_unused]] const sourcemeta::core::JSON &instance,                 \
       [[maybe_unused]] const std::uint64_t depth,                              \
-      [[maybe_unused]] DispatchContext<Track, Dynamic, HasCallback> &context)  \
-      -> bool
+      [[maybe_unused]] DispatchContext<Track, Dynamic, HasCallback, Schema>    \
+          &context) -> bool
 
 #define INSTRUCTION_DIRECT(name, value_type)                                   \
   SOURCEMETA_FORCEINLINE inline auto DIRECT_##name(                            \
@@ -1336,6 +1349,7 @@ INSTRUCTION_HANDLER(LogicalCondition) {
         context.evaluator->evaluate_path.pop_back(
             context.schema->extra[instruction.extra_index]
                 .relative_schema_location.size());
+        context.evaluator->leave_scopes();
       }
     }
 
@@ -1541,6 +1555,7 @@ INSTRUCTION_HANDLER(LogicalNotEvaluate) {
 
   const auto &target{
       resolve_instance(instance, instruction.relative_instance_location)};
+  const auto checkpoint{context.evaluator->evaluated_log_.size()};
   for (const auto &child : instruction.children) {
     if (!EVALUATE_RECURSE(child, target)) [[likely]] {
       result = true;
@@ -1548,7 +1563,7 @@ INSTRUCTION_HANDLER(LogicalNotEvaluate) {
     }
   }
 
-  context.evaluator->unevaluate();
+  context.evaluator->unevaluate(checkpoint);
 
   EVALUATE_END(LogicalNotEvaluate);
 }
@@ -2644,156 +2659,205 @@ INSTRUCTION_HANDLER(LoopContains) {
 
 #undef INSTRUCTION_HANDLER
 
-template <bool Track, bool Dynamic, bool HasCallback>
-using DispatchHandler = bool (*)(
-    const sourcemeta::blaze::Instruction &, const sourcemeta::core::JSON &,
-    std::uint64_t, DispatchContext<Track, Dynamic, HasCallback> &);
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
+using DispatchHandler =
+    bool (*)(const SchemaInstruction<Schema> &, const sourcemeta::core::JSON &,
+             std::uint64_t,
+             DispatchContext<Track, Dynamic, HasCallback, Schema> &);
 
-template <bool Track, bool Dynamic, bool HasCallback>
 // Must have same order as InstructionIndex
+#define DISPATCH_INSTRUCTIONS(X)                                               \
+  X(AssertionFail)                                                             \
+  X(AssertionDefines)                                                          \
+  X(AssertionDefinesStrict)                                                    \
+  X(AssertionDefinesAll)                                                       \
+  X(AssertionDefinesAllStrict)                                                 \
+  X(AssertionDefinesExactly)                                                   \
+  X(AssertionDefinesExactlyStrict)                                             \
+  X(AssertionDefinesExactlyStrictHash3)                                        \
+  X(AssertionPropertyDependencies)                                             \
+  X(AssertionType)                                                             \
+  X(AssertionTypeAny)                                                          \
+  X(AssertionTypeStrict)                                                       \
+  X(AssertionTypeStrictAny)                                                    \
+  X(AssertionNotTypeStrictAny)                                                 \
+  X(AssertionTypeStringBounded)                                                \
+  X(AssertionTypeStringUpper)                                                  \
+  X(AssertionTypeArrayBounded)                                                 \
+  X(AssertionTypeArrayUpper)                                                   \
+  X(AssertionTypeObjectBounded)                                                \
+  X(AssertionTypeObjectUpper)                                                  \
+  X(AssertionRegex)                                                            \
+  X(AssertionStringSizeLess)                                                   \
+  X(AssertionStringSizeGreater)                                                \
+  X(AssertionArraySizeLess)                                                    \
+  X(AssertionArraySizeGreater)                                                 \
+  X(AssertionObjectSizeLess)                                                   \
+  X(AssertionObjectSizeGreater)                                                \
+  X(AssertionEqual)                                                            \
+  X(AssertionEqualsAny)                                                        \
+  X(AssertionEqualsAnyStringHash)                                              \
+  X(AssertionGreaterEqual)                                                     \
+  X(AssertionLessEqual)                                                        \
+  X(AssertionGreater)                                                          \
+  X(AssertionLess)                                                             \
+  X(AssertionUnique)                                                           \
+  X(AssertionDivisible)                                                        \
+  X(AssertionTypeIntegerBounded)                                               \
+  X(AssertionTypeIntegerBoundedStrict)                                         \
+  X(AssertionTypeIntegerLowerBound)                                            \
+  X(AssertionTypeIntegerLowerBoundStrict)                                      \
+  X(AssertionStringType)                                                       \
+  X(AssertionPropertyType)                                                     \
+  X(AssertionPropertyTypeEvaluate)                                             \
+  X(AssertionPropertyTypeStrict)                                               \
+  X(AssertionPropertyTypeStrictEvaluate)                                       \
+  X(AssertionPropertyTypeStrictAny)                                            \
+  X(AssertionPropertyTypeStrictAnyEvaluate)                                    \
+  X(AssertionArrayPrefix)                                                      \
+  X(AssertionArrayPrefixEvaluate)                                              \
+  X(AssertionObjectPropertiesSimple)                                           \
+  X(AnnotationEmit)                                                            \
+  X(AnnotationToParent)                                                        \
+  X(AnnotationBasenameToParent)                                                \
+  X(Evaluate)                                                                  \
+  X(LogicalNot)                                                                \
+  X(LogicalNotEvaluate)                                                        \
+  X(LogicalOr)                                                                 \
+  X(LogicalAnd)                                                                \
+  X(LogicalXor)                                                                \
+  X(LogicalCondition)                                                          \
+  X(LogicalWhenType)                                                           \
+  X(LogicalWhenDefines)                                                        \
+  X(LogicalWhenArraySizeGreater)                                               \
+  X(LoopPropertiesUnevaluated)                                                 \
+  X(LoopPropertiesUnevaluatedExcept)                                           \
+  X(LoopPropertiesMatch)                                                       \
+  X(LoopPropertiesMatchClosed)                                                 \
+  X(LoopProperties)                                                            \
+  X(LoopPropertiesEvaluate)                                                    \
+  X(LoopPropertiesRegex)                                                       \
+  X(LoopPropertiesRegexClosed)                                                 \
+  X(LoopPropertiesStartsWith)                                                  \
+  X(LoopPropertiesExcept)                                                      \
+  X(LoopPropertiesType)                                                        \
+  X(LoopPropertiesTypeEvaluate)                                                \
+  X(LoopPropertiesExactlyTypeStrict)                                           \
+  X(LoopPropertiesExactlyTypeStrictHash)                                       \
+  X(LoopPropertiesTypeStrict)                                                  \
+  X(LoopPropertiesTypeStrictEvaluate)                                          \
+  X(LoopPropertiesTypeStrictAny)                                               \
+  X(LoopPropertiesTypeStrictAnyEvaluate)                                       \
+  X(LoopKeys)                                                                  \
+  X(LoopItems)                                                                 \
+  X(LoopItemsFrom)                                                             \
+  X(LoopItemsUnevaluated)                                                      \
+  X(LoopItemsType)                                                             \
+  X(LoopItemsTypeStrict)                                                       \
+  X(LoopItemsTypeStrictAny)                                                    \
+  X(LoopItemsPropertiesExactlyTypeStrictHash)                                  \
+  X(LoopItemsPropertiesExactlyTypeStrictHash3)                                 \
+  X(LoopItemsIntegerBounded)                                                   \
+  X(LoopItemsIntegerBoundedSized)                                              \
+  X(LoopContains)                                                              \
+  X(ControlGroup)                                                              \
+  X(ControlGroupWhenDefines)                                                   \
+  X(ControlGroupWhenDefinesDirect)                                             \
+  X(ControlGroupWhenType)                                                      \
+  X(ControlEvaluate)                                                           \
+  X(ControlDynamicAnchorJump)                                                  \
+  X(ControlJump)
+
+#define DISPATCH_HANDLER(name) name,
+
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
 // NOLINTNEXTLINE(modernize-avoid-c-arrays)
-static constexpr DispatchHandler<Track, Dynamic, HasCallback> handlers[100] = {
-    AssertionFail,
-    AssertionDefines,
-    AssertionDefinesStrict,
-    AssertionDefinesAll,
-    AssertionDefinesAllStrict,
-    AssertionDefinesExactly,
-    AssertionDefinesExactlyStrict,
-    AssertionDefinesExactlyStrictHash3,
-    AssertionPropertyDependencies,
-    AssertionType,
-    AssertionTypeAny,
-    AssertionTypeStrict,
-    AssertionTypeStrictAny,
-    AssertionNotTypeStrictAny,
-    AssertionTypeStringBounded,
-    AssertionTypeStringUpper,
-    AssertionTypeArrayBounded,
-    AssertionTypeArrayUpper,
-    AssertionTypeObjectBounded,
-    AssertionTypeObjectUpper,
-    AssertionRegex,
-    AssertionStringSizeLess,
-    AssertionStringSizeGreater,
-    AssertionArraySizeLess,
-    AssertionArraySizeGreater,
-    AssertionObjectSizeLess,
-    AssertionObjectSizeGreater,
-    AssertionEqual,
-    AssertionEqualsAny,
-    AssertionEqualsAnyStringHash,
-    AssertionGreaterEqual,
-    AssertionLessEqual,
-    AssertionGreater,
-    AssertionLess,
-    AssertionUnique,
-    AssertionDivisible,
-    AssertionTypeIntegerBounded,
-    AssertionTypeIntegerBoundedStrict,
-    AssertionTypeIntegerLowerBound,
-    AssertionTypeIntegerLowerBoundStrict,
-    AssertionStringType,
-    AssertionPropertyType,
-    AssertionPropertyTypeEvaluate,
-    AssertionPropertyTypeStrict,
-    AssertionPropertyTypeStrictEvaluate,
-    AssertionPropertyTypeStrictAny,
-    AssertionPropertyTypeStrictAnyEvaluate,
-    AssertionArrayPrefix,
-    AssertionArrayPrefixEvaluate,
-    AssertionObjectPropertiesSimple,
-    AnnotationEmit,
-    AnnotationToParent,
-    AnnotationBasenameToParent,
-    Evaluate,
-    LogicalNot,
-    LogicalNotEvaluate,
-    LogicalOr,
-    LogicalAnd,
-    LogicalXor,
-    LogicalCondition,
-    LogicalWhenType,
-    LogicalWhenDefines,
-    LogicalWhenArraySizeGreater,
-    LoopPropertiesUnevaluated,
-    LoopPropertiesUnevaluatedExcept,
-    LoopPropertiesMatch,
-    LoopPropertiesMatchClosed,
-    LoopProperties,
-    LoopPropertiesEvaluate,
-    LoopPropertiesRegex,
-    LoopPropertiesRegexClosed,
-    LoopPropertiesStartsWith,
-    LoopPropertiesExcept,
-    LoopPropertiesType,
-    LoopPropertiesTypeEvaluate,
-    LoopPropertiesExactlyTypeStrict,
-    LoopPropertiesExactlyTypeStrictHash,
-    LoopPropertiesTypeStrict,
-    LoopPropertiesTypeStrictEvaluate,
-    LoopPropertiesTypeStrictAny,
-    LoopPropertiesTypeStrictAnyEvaluate,
-    LoopKeys,
-    LoopItems,
-    LoopItemsFrom,
-    LoopItemsUnevaluated,
-    LoopItemsType,
-    LoopItemsTypeStrict,
-    LoopItemsTypeStrictAny,
-    LoopItemsPropertiesExactlyTypeStrictHash,
-    LoopItemsPropertiesExactlyTypeStrictHash3,
-    LoopItemsIntegerBounded,
-    LoopItemsIntegerBoundedSized,
-    LoopContains,
-    ControlGroup,
-    ControlGroupWhenDefines,
-    ControlGroupWhenDefinesDirect,
-    ControlGroupWhenType,
-    ControlEvaluate,
-    ControlDynamicAnchorJump,
-    ControlJump};
-
-template <bool Track, bool Dynamic, bool HasCallback>
-inline auto
-evaluate_instruction(const sourcemeta::blaze::Instruction &instruction,
-                     const sourcemeta::core::JSON &instance,
-                     const std::uint64_t depth,
-                     DispatchContext<Track, Dynamic, HasCallback> &context)
-    -> bool {
-  constexpr auto DEPTH_LIMIT{300};
-  if (depth > DEPTH_LIMIT) [[unlikely]] {
+static constexpr DispatchHandler<Track, Dynamic, HasCallback, Schema>
+    handlers[100] = {DISPATCH_INSTRUCTIONS(DISPATCH_HANDLER)};
+
+#undef DISPATCH_HANDLER
+
+SOURCEMETA_FORCEINLINE inline auto
+guard_depth(const std::uint64_t depth,
+            const sourcemeta::blaze::Evaluator &evaluator) -> void {
+  if (depth > evaluator.depth_limit) [[unlikely]] {
     throw EvaluationError("The evaluation path depth limit was reached "
                           "likely due to infinite recursion");
   }
 
-  return handlers<Track, Dynamic, HasCallback>[std::to_underlying(
+#if defined(__GNUC__)
+  // See `Evaluator::stack_floor`
+  if (reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0)) <
+      evaluator.stack_floor) [[unlikely]] {
+    throw EvaluationError("The evaluation stack was exhausted");
+  }
+#endif
+}
+
+#if defined(SOURCEMETA_BLAZE_EVALUATOR_THREADED_DISPATCH) && defined(__GNUC__)
+#define DISPATCH_COMPUTED_GOTO
+#endif
+
+#if defined(DISPATCH_COMPUTED_GOTO)
+#pragma GCC diagnostic push
+// Labels as values are a GNU extension
+#pragma GCC diagnostic ignored "-Wpedantic"
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wgnu-label-as-value"
+#endif
+#endif
+
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
+inline auto evaluate_instruction(
+    const SchemaInstruction<Schema> &instruction,
+    const sourcemeta::core::JSON &instance, const std::uint64_t depth,
+    DispatchContext<Track, Dynamic, HasCallback, Schema> &context) -> bool {
+  guard_depth(depth, *context.evaluator);
+
+#if defined(DISPATCH_COMPUTED_GOTO)
+  // Jump through a table of labels, each of which makes a direct call to
+  // its handler. The indirect branch becomes a jump rather than a call, and
+  // the compiler is free to inline every handler at its label
+#define DISPATCH_LABEL_ADDRESS(name) &&label_##name,
+#define DISPATCH_LABEL(name)                                                   \
+  label_##name : return name<Track, Dynamic, HasCallback, Schema>(             \
+                     instruction, instance, depth, context);
+  // NOLINTNEXTLINE(modernize-avoid-c-arrays)
+  static void *const labels[100] = {DISPATCH_INSTRUCTIONS(
+      DISPATCH_LABEL_ADDRESS)};
+  goto *labels[std::to_underlying(instruction.type)];
+  DISPATCH_INSTRUCTIONS(DISPATCH_LABEL)
+#undef DISPATCH_LABEL_ADDRESS
+#undef DISPATCH_LABEL
+#else
+  return handlers<Track, Dynamic, HasCallback, Schema>[std::to_underlying(
       instruction.type)](instruction, instance, depth, context);
+#endif
 }
 
-template <bool Track, bool Dynamic, bool HasCallback>
+#if defined(DISPATCH_COMPUTED_GOTO)
+#pragma GCC diagnostic pop
+#endif
+
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
 inline auto evaluate_instruction_without_callback(
-    const sourcemeta::blaze::Instruction &instruction,
+    const SchemaInstruction<Schema> &instruction,
     const sourcemeta::core::JSON &instance, const std::uint64_t depth,
-    DispatchContext<Track, Dynamic, HasCallback> &context) -> bool {
-  constexpr auto DEPTH_LIMIT{300};
-  if (depth > DEPTH_LIMIT) [[unlikely]] {
-    throw EvaluationError("The evaluation path depth limit was reached "
-                          "likely due to infinite recursion");
-  }
+    DispatchContext<Track, Dynamic, HasCallback, Schema> &context) -> bool {
+  guard_depth(depth, *context.evaluator);
 
-  DispatchContext<false, Dynamic, false> plain_context{
+  DispatchContext<false, Dynamic, false, Schema> plain_context{
       context.schema, context.callback, context.evaluator,
       context.property_target};
-  return handlers<false, Dynamic, false>[std::to_underlying(instruction.type)](
-      instruction, instance, depth, plain_context);
+  return handlers<false, Dynamic, false, Schema>[std::to_underlying(
+      instruction.type)](instruction, instance, depth, plain_context);
 }
 
-template <bool Track, bool Dynamic, bool HasCallback>
+template <bool Track, bool Dynamic, bool HasCallback, typename Schema>
 inline auto evaluate_instruction_with_property(
-    const sourcemeta::blaze::Instruction &instruction,
+    const SchemaInstruction<Schema> &instruction,
     const sourcemeta::core::JSON &instance, const std::uint64_t depth,
-    DispatchContext<Track, Dynamic, HasCallback> &context,
+    DispatchContext<Track, Dynamic, HasCallback, Schema> &context,
     const sourcemeta::core::JSON::String &name) -> bool {
   const auto *previous = context.property_target;
   context.property_target = &name;
@@ -2820,6 +2884,8 @@ inline auto evaluate_instruction_with_property(
 #undef EVALUATE_ANNOTATION
 #undef EVALUATE_RECURSE
 #undef EVALUATE_RECURSE_ON_PROPERTY_NAME
+#undef DISPATCH_INSTRUCTIONS
+#undef DISPATCH_COMPUTED_GOTO
 #undef SOURCEMETA_ASSUME
 #undef SOURCEMETA_STRINGIFY
 
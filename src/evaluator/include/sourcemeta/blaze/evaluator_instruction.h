@@ -10,6 +10,7 @@
 #include <sourcemeta/core/jsonpointer.h>
 
 #include <cstdint>     // std::uint8_t
+#include <span>        // std::span
 #include <string>      // std::string
 #include <string_view> // std::string_view
 #include <vector>      // std::vector
@@ -270,6 +271,20 @@ struct Instruction {
   std::size_t extra_index;
 };
 
+/// @ingroup evaluator
+/// Represents a single instruction of a linked template (see `link`). Unlike
+/// `Instruction`, it does not own any of its data. Its children are a span
+/// over the contiguous instruction table of the linked template, while its
+/// value and relative instance location point to the side tables of the
+/// linked template
+struct LinkedInstruction {
+  InstructionIndex type;
+  const sourcemeta::core::Pointer &relative_instance_location;
+  const Value &value;
+  std::span<const LinkedInstruction> children;
+  std::size_t extra_index;
+};
+
 /// @ingroup evaluator
 ///
 /// This function translates a "post" step execution into a human-readable
@@ -0,0 +1,160 @@
+#ifndef SOURCEMETA_BLAZE_EVALUATOR_MARK_SET_H
+#define SOURCEMETA_BLAZE_EVALUATOR_MARK_SET_H
+
+#ifndef SOURCEMETA_BLAZE_EVALUATOR_EXPORT
+#include <sourcemeta/blaze/evaluator_export.h>
+#endif
+
+#include <sourcemeta/core/json.h>
+
+#include <algorithm> // std::ranges::fill
+#include <cassert>   // assert
+#include <cstddef>   // std::size_t
+#include <cstdint>   // std::uintptr_t
+#include <utility>   // std::pair, std::exchange
+#include <vector>    // std::vector
+
+namespace sourcemeta::blaze {
+
+/// @ingroup evaluator
+/// A set of instance locations paired with evaluate path scopes, stored in a
+/// single open-addressing table. Clearing the set keeps its table around, so
+/// reusing an evaluator does not allocate once the table is large enough
+class SOURCEMETA_BLAZE_EVALUATOR_EXPORT MarkSet {
+public:
+  using value_type = std::pair<const sourcemeta::core::JSON *, std::size_t>;
+
+  /// Insert an entry, returning whether it was not in the set already
+  inline auto insert(const value_type &value) -> bool {
+    assert(value.first);
+    if ((this->size_ + 1) * 2 > this->slots.size()) {
+      this->grow();
+    }
+
+    auto index{this->home(value)};
+    while (this->slots[index].first) {
+      if (this->slots[index] == value) {
+        return false;
+      }
+
+      index = (index + 1) & this->mask();
+    }
+
+    this->slots[index] = value;
+    this->size_ += 1;
+    return true;
+  }
+
+  [[nodiscard]] inline auto contains(const value_type &value) const noexcept
+      -> bool {
+    if (this->size_ == 0) {
+      return false;
+    }
+
+    for (auto index{this->home(value)}; this->slots[index].first;
+         index = (index + 1) & this->mask()) {
+      if (this->slots[index] == value) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  inline auto erase(const value_type &value) noexcept -> void {
+    if (this->size_ == 0) {
+      return;
+    }
+
+    auto index{this->home(value)};
+    while (this->slots[index] != value) {
+      if (!this->slots[index].first) {
+        return;
+      }
+
+      index = (index + 1) & this->mask();
+    }
+
+    // Shift back the entries that follow in the same run, so that lookups
+    // never stop at the hole we leave
+    auto next{(index + 1) & this->mask()};
+    while (this->slots[next].first) {
+      const auto next_home{this->home(this->slots[next])};
+      if (((next - next_home) & this->mask()) >=
+          ((next - index) & this->mask())) {
+        this->slots[index] = this->slots[next];
+        index = next;
+      }
+
+      next = (next + 1) & this->mask();
+    }
+
+    this->slots[index] = EMPTY;
+    this->size_ -= 1;
+  }
+
+  inline auto clear() noexcept -> void {
+    if (std::exchange(this->size_, 0) > 0) {
+      std::ranges::fill(this->slots, EMPTY);
+    }
+  }
+
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t {
+    return this->size_;
+  }
+
+  [[nodiscard]] inline auto empty() const noexcept -> bool {
+    return this->size_ == 0;
+  }
+
+private:
+  static constexpr value_type EMPTY{nullptr, 0};
+  static constexpr std::size_t MINIMUM_CAPACITY{64};
+
+  [[nodiscard]] inline auto mask() const noexcept -> std::size_t {
+    return this->slots.size() - 1;
+  }
+
+  [[nodiscard]] inline auto home(const value_type &value) const noexcept
+      -> std::size_t {
+    // Instance locations are at least pointer-aligned, so their lowest bits
+    // carry no information
+    auto hash{(reinterpret_cast<std::uintptr_t>(value.first) >> 3) ^
+              (value.second * 0x9E3779B97F4A7C15ULL)};
+    hash ^= hash >> 29;
+    return static_cast<std::size_t>(hash) & this->mask();
+  }
+
+  inline auto grow() -> void {
+    std::vector<value_type> previous(
+        std::max(MINIMUM_CAPACITY, this->slots.size() * 2), EMPTY);
+    previous.swap(this->slots);
+    for (const auto &entry : previous) {
+      if (entry.first) {
+        auto index{this->home(entry)};
+        while (this->slots[index].first) {
+          index = (index + 1) & this->mask();
+        }
+
+        this->slots[index] = entry;
+      }
+    }
+  }
+
+// Exporting symbols that depends on the standard C++ library is considered
+// safe.
+// https://learn.microsoft.com/en-us/cpp/error-messages/compiler-warnings/compiler-warning-level-2-c4275?view=msvc-170&redirectedfrom=MSDN
+#if defined(_MSC_VER)
+#pragma warning(disable : 4251 4275)
+#endif
+  // An entry without an instance location marks an empty slot
+  std::vector<value_type> slots;
+#if defined(_MSC_VER)
+#pragma warning(default : 4251 4275)
+#endif
+  std::size_t size_{0};
+};
+
+} // namespace sourcemeta::blaze
+
+#endif
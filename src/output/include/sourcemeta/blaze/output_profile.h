@@ -0,0 +1,163 @@
+#ifndef SOURCEMETA_BLAZE_OUTPUT_PROFILE_H_
+#define SOURCEMETA_BLAZE_OUTPUT_PROFILE_H_
+
+#ifndef SOURCEMETA_BLAZE_OUTPUT_EXPORT
+#include <sourcemeta/blaze/output_export.h>
+#endif
+
+#include <sourcemeta/core/json.h>
+#include <sourcemeta/core/jsonpointer.h>
+
+#include <sourcemeta/blaze/evaluator.h>
+
+#include <chrono>  // std::chrono::steady_clock, std::chrono::nanoseconds
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint64_t
+// TODO(C++23): Consider std::flat_map/std::flat_set when available in libc++
+#include <map>     // std::map
+#include <ostream> // std::ostream
+#include <string>  // std::string
+#include <utility> // std::pair
+#include <vector>  // std::vector
+
+namespace sourcemeta::blaze {
+
+/// @ingroup output
+///
+/// An evaluation callback that measures how often every instruction runs, how
+/// often it fails, and how much time it takes, both by itself and including
+/// the instructions it evaluates. The profile accumulates across any number of
+/// evaluations, so that it can describe real traffic rather than a single
+/// instance. Profiling only happens when passing this callback, so evaluations
+/// without it pay nothing for it. For example:
+///
+/// ```cpp
+/// #include <sourcemeta/blaze/compiler.h>
+/// #include <sourcemeta/blaze/evaluator.h>
+/// #include <sourcemeta/blaze/output.h>
+///
+/// #include <sourcemeta/core/json.h>
+/// #include <sourcemeta/blaze/foundation.h>
+///
+/// #include <cassert>
+/// #include <functional>
+/// #include <iostream>
+///
+/// const sourcemeta::core::JSON schema =
+///     sourcemeta::core::parse_json(R"JSON({
+///   "$schema": "https://json-schema.org/draft/2020-12/schema",
+///   "type": "string"
+/// })JSON");
+///
+/// const auto schema_template{sourcemeta::blaze::compile(
+///     schema, sourcemeta::blaze::schema_walker,
+///     sourcemeta::blaze::schema_resolver,
+///     sourcemeta::blaze::default_schema_compiler)};
+///
+/// sourcemeta::blaze::ProfileOutput profile;
+/// sourcemeta::blaze::Evaluator evaluator;
+/// const sourcemeta::core::JSON instance{"foo"};
+/// for (auto iteration = 0; iteration < 1000; iteration++) {
+///   evaluator.validate(schema_template, instance, std::ref(profile));
+/// }
+///
+/// sourcemeta::core::prettify(profile.to_json(), std::cout);
+/// std::cout << "\n";
+///
+/// // Render with https://github.com/brendangregg/FlameGraph
+/// profile.folded(std::cerr);
+/// ```
+///
+/// Timings come from the steady clock, which on common platforms reads the
+/// time stamp counter without a system call. Every timed instruction also pays
+/// for reading the clock and for going through the evaluation callback, so
+/// absolute timings are inflated, but the relative cost of every keyword is
+/// preserved.
+class SOURCEMETA_BLAZE_OUTPUT_EXPORT ProfileOutput {
+public:
+  ProfileOutput() = default;
+
+  // Prevent accidental copies
+  ProfileOutput(const ProfileOutput &) = delete;
+  auto operator=(const ProfileOutput &) -> ProfileOutput & = delete;
+
+  struct Entry {
+    std::string keyword_location;
+    // How many times the instructions at this location were evaluated
+    std::uint64_t count;
+    // How many of those evaluations failed
+    std::uint64_t failures;
+    // The time spent in the instructions at this location, excluding the
+    // instructions they evaluated
+    std::chrono::nanoseconds self;
+    // The time spent in the instructions at this location, including the
+    // instructions they evaluated. Recursive evaluations of the same location
+    // are only counted once
+    std::chrono::nanoseconds inclusive;
+  };
+
+  auto operator()(const EvaluationType type, const bool result,
+                  const Instruction &step,
+                  const InstructionExtra &step_metadata,
+                  const sourcemeta::core::WeakPointer &evaluate_path,
+                  const sourcemeta::core::WeakPointer &instance_location,
+                  const sourcemeta::core::JSON &annotation) -> void;
+
+  /// The profile of every keyword location, from the one that took the most
+  /// time by itself to the one that took the least
+  [[nodiscard]] auto entries() const -> std::vector<Entry>;
+
+  /// The profile of every keyword location (see `entries`) as a JSON array
+  [[nodiscard]] auto to_json() const -> sourcemeta::core::JSON;
+
+  /// Write the time spent by itself in every chain of keyword locations, in
+  /// nanoseconds, in the folded stacks format that flame graph tools consume
+  auto folded(std::ostream &stream) const -> void;
+
+  /// Discard everything measured so far
+  auto reset() -> void;
+
+private:
+  // Every distinct chain of keyword locations is a node in a call tree
+  struct Node {
+    std::size_t parent;
+    std::string keyword_location;
+    std::uint64_t count;
+    std::uint64_t failures;
+    std::chrono::nanoseconds self;
+    std::chrono::nanoseconds inclusive;
+  };
+
+  struct Frame {
+    std::size_t node;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::nanoseconds children;
+  };
+
+// Exporting symbols that depends on the standard C++ library is considered
+// safe.
+// https://learn.microsoft.com/en-us/cpp/error-messages/compiler-warnings/compiler-warning-level-2-c4275?view=msvc-170&redirectedfrom=MSDN
+#if defined(_MSC_VER)
+#pragma warning(disable : 4251)
+#endif
+  // The first node is the root of the tree, which does not correspond to any
+  // instruction
+  std::vector<Node> nodes{Node{.parent = 0,
+                               .keyword_location = {},
+                               .count = 0,
+                               .failures = 0,
+                               .self = {},
+                               .inclusive = {}}};
+  // Instruction metadata is unique to every instruction of a template, so we
+  // can find the node of an instruction without comparing strings
+  std::map<std::pair<std::size_t, const InstructionExtra *>, std::size_t>
+      children;
+  std::vector<Frame> stack;
+#if defined(_MSC_VER)
+#pragma warning(default : 4251)
+#endif
+};
+
+} // namespace sourcemeta::blaze
+
+#endif
@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+
+#include <sourcemeta/blaze/compiler.h>
+#include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/blaze/foundation.h>
+
+#include <sourcemeta/core/io.h>
+#include <sourcemeta/core/json.h>
+
+#include <filesystem> // std::filesystem
+#include <fstream>    // std::ofstream, std::ifstream
+#include <iterator>   // std::istreambuf_iterator
+#include <sstream>    // std::ostringstream
+#include <string>     // std::string
+#include <utility>    // std::move
+#include <variant>    // std::get
+
+static auto binary_test_template() -> sourcemeta::blaze::Template {
+  const auto schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "type": "object",
+    "required": [ "name" ],
+    "properties": {
+      "name": { "type": "string", "pattern": "^[a-z]+$" },
+      "age": { "type": "integer", "minimum": 0, "maximum": 150 },
+      "tags": { "type": "array", "items": { "enum": [ "a", "b", "c" ] } }
+    },
+    "patternProperties": {
+      "^x-": { "$ref": "#/$defs/extension" }
+    },
+    "$defs": {
+      "extension": { "anyOf": [ { "type": "string" }, { "type": "null" } ] }
+    }
+  })JSON")};
+
+  return sourcemeta::blaze::compile(schema, sourcemeta::blaze::schema_walker,
+                                    sourcemeta::blaze::schema_resolver,
+                                    sourcemeta::blaze::default_schema_compiler,
+                                    sourcemeta::blaze::Mode::Exhaustive);
+}
+
+static auto write_binary(const sourcemeta::blaze::Template &schema_template,
+                         const std::filesystem::path &path) -> void {
+  std::ofstream stream{path, std::ios::binary};
+  sourcemeta::blaze::to_binary(schema_template, stream);
+}
+
+static auto read_bytes(const std::filesystem::path &path) -> std::string {
+  std::ifstream stream{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{stream},
+          std::istreambuf_iterator<char>{}};
+}
+
+static auto write_bytes(const std::filesystem::path &path,
+                        const std::string &bytes) -> void {
+  std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+  stream.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+TEST(Evaluator_binary, round_trip) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  const auto schema_template{binary_test_template()};
+  write_binary(schema_template, path);
+
+  const auto linked{sourcemeta::blaze::from_binary(path)};
+  EXPECT_TRUE(linked.has_value());
+  EXPECT_EQ(linked.value().dynamic, schema_template.dynamic);
+  EXPECT_EQ(linked.value().track, schema_template.track);
+  EXPECT_EQ(linked.value().targets.size(), schema_template.targets.size());
+  EXPECT_EQ(linked.value().labels, schema_template.labels);
+  EXPECT_EQ(linked.value().extra.size(), schema_template.extra.size());
+  for (std::size_t index = 0; index < schema_template.extra.size(); index++) {
+    EXPECT_EQ(linked.value().extra[index].keyword_location,
+              schema_template.extra[index].keyword_location);
+    EXPECT_EQ(linked.value().extra[index].relative_schema_location,
+              schema_template.extra[index].relative_schema_location);
+  }
+
+  const auto instances{sourcemeta::core::parse_json(R"JSON([
+    { "name": "john", "age": 30, "tags": [ "a", "c" ], "x-foo": null },
+    { "name": "john", "x-foo": "bar" },
+    { "name": "John" },
+    { "name": "john", "age": -1 },
+    { "name": "john", "tags": [ "d" ] },
+    { "name": "john", "x-foo": 1 },
+    { "age": 30 },
+    "foo"
+  ])JSON")};
+
+  sourcemeta::blaze::Evaluator evaluator;
+  for (const auto &instance : instances.as_array()) {
+    EXPECT_EQ(evaluator.validate(linked.value(), instance),
+              evaluator.validate(schema_template, instance));
+  }
+}
+
+TEST(Evaluator_binary, deterministic) {
+  const auto schema_template{binary_test_template()};
+  std::ostringstream first;
+  sourcemeta::blaze::to_binary(schema_template, first);
+  std::ostringstream second;
+  sourcemeta::blaze::to_binary(schema_template, second);
+  EXPECT_EQ(first.str(), second.str());
+}
+
+TEST(Evaluator_binary, cost) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  write_binary(binary_test_template(), path);
+
+  sourcemeta::blaze::BinaryLoadCost cost{};
+  const auto linked{sourcemeta::blaze::from_binary(path, &cost)};
+  EXPECT_TRUE(linked.has_value());
+  EXPECT_EQ(cost.bytes, std::filesystem::file_size(path));
+  EXPECT_EQ(cost.instructions, linked.value().instructions.size());
+  // The `pattern` regular expression, as the `patternProperties` one is
+  // compiled as a prefix match
+  EXPECT_EQ(cost.regexes, 1U);
+  EXPECT_GT(cost.duration.count(), 0);
+}
+
+TEST(Evaluator_binary, invalid_magic) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  write_binary(binary_test_template(), path);
+  auto bytes{read_bytes(path)};
+  bytes[0] = 'X';
+  write_bytes(path, bytes);
+  EXPECT_FALSE(sourcemeta::blaze::from_binary(path).has_value());
+}
+
+TEST(Evaluator_binary, version_mismatch) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  write_binary(binary_test_template(), path);
+  auto bytes{read_bytes(path)};
+  // The version is the second double word of the header
+  bytes[4] = static_cast<char>(sourcemeta::blaze::BINARY_VERSION + 1);
+  write_bytes(path, bytes);
+  EXPECT_FALSE(sourcemeta::blaze::from_binary(path).has_value());
+}
+
+TEST(Evaluator_binary, checksum_mismatch) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  write_binary(binary_test_template(), path);
+  auto bytes{read_bytes(path)};
+  bytes[bytes.size() / 2] = static_cast<char>(~bytes[bytes.size() / 2]);
+  write_bytes(path, bytes);
+  EXPECT_FALSE(sourcemeta::blaze::from_binary(path).has_value());
+}
+
+TEST(Evaluator_binary, truncated) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  write_binary(binary_test_template(), path);
+  const auto bytes{read_bytes(path)};
+  write_bytes(path, bytes.substr(0, bytes.size() - 1));
+  EXPECT_FALSE(sourcemeta::blaze::from_binary(path).has_value());
+  write_bytes(path, bytes.substr(0, 8));
+  EXPECT_FALSE(sourcemeta::blaze::from_binary(path).has_value());
+}
+
+static auto single_instruction_template(
+    const sourcemeta::blaze::InstructionIndex type,
+    sourcemeta::blaze::Value value) -> sourcemeta::blaze::Template {
+  sourcemeta::blaze::Template result{.dynamic = false,
+                                     .track = false,
+                                     .targets = {},
+                                     .labels = {},
+                                     .extra = {{.relative_schema_location = {},
+                                                .keyword_location = "#",
+                                                .schema_resource = 0}}};
+  result.targets.push_back({{.type = type,
+                             .relative_instance_location = {},
+                             .value = std::move(value),
+                             .children = {},
+                             .extra_index = 0}});
+  return result;
+}
+
+TEST(Evaluator_binary, control_jump_out_of_range) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  // The checksum matches, but there is no second target to jump to
+  write_binary(single_instruction_template(
+                   sourcemeta::blaze::InstructionIndex::ControlJump,
+                   sourcemeta::blaze::ValueUnsignedInteger{1}),
+               path);
+  EXPECT_FALSE(sourcemeta::blaze::from_binary(path).has_value());
+  write_binary(single_instruction_template(
+                   sourcemeta::blaze::InstructionIndex::ControlJump,
+                   sourcemeta::blaze::ValueUnsignedInteger{0}),
+               path);
+  EXPECT_TRUE(sourcemeta::blaze::from_binary(path).has_value());
+}
+
+TEST(Evaluator_binary, unexpected_value_alternative) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  // The handler of this instruction assumes a JSON value
+  write_binary(single_instruction_template(
+                   sourcemeta::blaze::InstructionIndex::AssertionEqual,
+                   sourcemeta::blaze::ValueString{"foo"}),
+               path);
+  EXPECT_FALSE(sourcemeta::blaze::from_binary(path).has_value());
+  write_binary(single_instruction_template(
+                   sourcemeta::blaze::InstructionIndex::AssertionEqual,
+                   sourcemeta::blaze::ValueJSON{"foo"}),
+               path);
+  EXPECT_TRUE(sourcemeta::blaze::from_binary(path).has_value());
+}
+
+TEST(Evaluator_binary, logical_condition_out_of_range) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  // The instruction has no children to split
+  write_binary(single_instruction_template(
+                   sourcemeta::blaze::InstructionIndex::LogicalCondition,
+                   sourcemeta::blaze::ValueIndexPair{1, 2}),
+               path);
+  EXPECT_FALSE(sourcemeta::blaze::from_binary(path).has_value());
+}
+
+TEST(Evaluator_binary, json_values) {
+  const sourcemeta::core::TemporaryDirectory directory{
+      std::filesystem::temp_directory_path(), ".blaze-binary-"};
+  const auto path{directory.path() / "template.bin"};
+  const auto value{sourcemeta::core::parse_json(R"JSON({
+    "null": null,
+    "boolean": true,
+    "integer": -42,
+    "real": 3.25,
+    "decimal": 123456789012345678901234567890,
+    "string": "foo",
+    "array": [ 1, [ 2, { "nested": [] } ], {} ]
+  })JSON")};
+  const auto schema_template{single_instruction_template(
+      sourcemeta::blaze::InstructionIndex::AssertionEqual, value)};
+  write_binary(schema_template, path);
+  const auto linked{sourcemeta::blaze::from_binary(path)};
+  EXPECT_TRUE(linked.has_value());
+  EXPECT_EQ(
+      std::get<sourcemeta::blaze::ValueJSON>(linked.value().values.at(0)),
+      value);
+
+  sourcemeta::blaze::Evaluator evaluator;
+  EXPECT_TRUE(evaluator.validate(linked.value(), value));
+  EXPECT_FALSE(evaluator.validate(linked.value(), sourcemeta::core::JSON{1}));
+}
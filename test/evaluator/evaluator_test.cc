@@ -8,7 +8,13 @@
 
 #include <sourcemeta/core/json.h>
 
+#include <cstddef>     // std::size_t
+#include <memory>      // std::make_unique
+#include <stdexcept>   // std::invalid_argument
+#include <string>      // std::to_string
 #include <type_traits> // std::is_copy_constructible_v, etc.
+#include <utility>     // std::move
+#include <vector>      // std::vector
 
 #include "evaluator_utils.h"
 
@@ -453,3 +459,557 @@ TEST(Evaluator,
   const auto result{evaluator.validate(compiled_schema, instance)};
   EXPECT_TRUE(result);
 }
+
+TEST(Evaluator, mark_set_insert_erase) {
+  // Enough entries to grow the table a few times and to produce long runs
+  std::vector<sourcemeta::core::JSON> locations(500, sourcemeta::core::JSON{1});
+  sourcemeta::blaze::MarkSet set;
+  for (std::size_t scope = 0; scope < 4; scope++) {
+    for (const auto &location : locations) {
+      EXPECT_TRUE(set.insert({&location, scope}));
+      EXPECT_FALSE(set.insert({&location, scope}));
+    }
+  }
+
+  EXPECT_EQ(set.size(), 2000);
+
+  // Drop every other entry, and check that the rest are still reachable
+  for (std::size_t scope = 0; scope < 4; scope++) {
+    for (std::size_t index = scope % 2; index < locations.size(); index += 2) {
+      set.erase({&locations[index], scope});
+    }
+  }
+
+  EXPECT_EQ(set.size(), 1000);
+  for (std::size_t scope = 0; scope < 4; scope++) {
+    for (std::size_t index = 0; index < locations.size(); index++) {
+      EXPECT_EQ(set.contains({&locations[index], scope}),
+                index % 2 != scope % 2);
+    }
+  }
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.contains({&locations.front(), 0}));
+}
+
+static auto unevaluated_validate(const sourcemeta::core::JSON &schema,
+                                 const sourcemeta::core::JSON &instance)
+    -> bool {
+  sourcemeta::blaze::Evaluator evaluator;
+  const auto fast{evaluator.validate(
+      sourcemeta::blaze::compile(schema, sourcemeta::blaze::schema_walker,
+                                 sourcemeta::blaze::schema_resolver,
+                                 sourcemeta::blaze::default_schema_compiler,
+                                 sourcemeta::blaze::Mode::FastValidation),
+      instance)};
+  const auto exhaustive{evaluator.validate(
+      sourcemeta::blaze::compile(schema, sourcemeta::blaze::schema_walker,
+                                 sourcemeta::blaze::schema_resolver,
+                                 sourcemeta::blaze::default_schema_compiler,
+                                 sourcemeta::blaze::Mode::Exhaustive),
+      instance,
+      [](const sourcemeta::blaze::EvaluationType, const bool,
+         const sourcemeta::blaze::Instruction &,
+         const sourcemeta::blaze::InstructionExtra &,
+         const sourcemeta::core::WeakPointer &,
+         const sourcemeta::core::WeakPointer &,
+         const sourcemeta::core::JSON &) -> void {})};
+  EXPECT_EQ(fast, exhaustive);
+  return fast;
+}
+
+TEST(Evaluator, unevaluated_properties_large_object) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "anyOf": [
+      { "patternProperties": { "^key": { "type": "integer" } } },
+      { "required": [ "never" ] }
+    ],
+    "unevaluatedProperties": false
+  })JSON")};
+
+  auto instance{sourcemeta::core::JSON::make_object()};
+  for (std::size_t index = 0; index < 1000; index++) {
+    instance.assign("key" + std::to_string(index),
+                    sourcemeta::core::JSON{index});
+  }
+
+  EXPECT_TRUE(unevaluated_validate(schema, instance));
+  instance.assign("other", sourcemeta::core::JSON{true});
+  EXPECT_FALSE(unevaluated_validate(schema, instance));
+}
+
+TEST(Evaluator, unevaluated_items_large_array) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "anyOf": [
+      { "contains": { "type": "integer" } },
+      { "minItems": 5000 }
+    ],
+    "unevaluatedItems": false
+  })JSON")};
+
+  auto instance{sourcemeta::core::JSON::make_array()};
+  for (std::size_t index = 0; index < 1000; index++) {
+    instance.push_back(sourcemeta::core::JSON{index});
+  }
+
+  EXPECT_TRUE(unevaluated_validate(schema, instance));
+  instance.push_back(sourcemeta::core::JSON{"foo"});
+  EXPECT_FALSE(unevaluated_validate(schema, instance));
+}
+
+TEST(Evaluator, unevaluated_properties_not_drops_evaluations) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "not": { "not": { "properties": { "foo": true } } },
+    "unevaluatedProperties": false
+  })JSON")};
+
+  EXPECT_TRUE(unevaluated_validate(schema, sourcemeta::core::parse_json("{}")));
+  EXPECT_FALSE(unevaluated_validate(
+      schema, sourcemeta::core::parse_json(R"JSON({ "foo": 1 })JSON")));
+}
+
+TEST(Evaluator, unevaluated_properties_not_keeps_earlier_evaluations) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "allOf": [
+      { "properties": { "foo": true } },
+      { "not": { "not": { "properties": { "foo": true, "bar": true } } } }
+    ],
+    "unevaluatedProperties": false
+  })JSON")};
+
+  EXPECT_TRUE(unevaluated_validate(
+      schema, sourcemeta::core::parse_json(R"JSON({ "foo": 1 })JSON")));
+  EXPECT_FALSE(unevaluated_validate(
+      schema,
+      sourcemeta::core::parse_json(R"JSON({ "foo": 1, "bar": 2 })JSON")));
+}
+
+TEST(Evaluator, unevaluated_properties_not_in_items) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "items": {
+      "anyOf": [
+        { "not": { "not": { "properties": { "foo": true } } } },
+        { "properties": { "bar": true } }
+      ],
+      "unevaluatedProperties": false
+    }
+  })JSON")};
+
+  EXPECT_TRUE(unevaluated_validate(
+      schema, sourcemeta::core::parse_json(R"JSON([ {}, { "bar": 1 } ])JSON")));
+  EXPECT_FALSE(unevaluated_validate(
+      schema, sourcemeta::core::parse_json(
+                  R"JSON([ { "bar": 1 }, { "foo": 1 } ])JSON")));
+}
+
+TEST(Evaluator, unevaluated_properties_nested) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "anyOf": [
+      { "properties": { "bar": true } },
+      { "properties": { "nested": { "properties": { "baz": true } } } }
+    ],
+    "properties": {
+      "nested": {
+        "anyOf": [ { "properties": { "foo": true } } ],
+        "unevaluatedProperties": false
+      }
+    },
+    "unevaluatedProperties": false
+  })JSON")};
+
+  EXPECT_TRUE(unevaluated_validate(
+      schema, sourcemeta::core::parse_json(
+                  R"JSON({ "nested": { "foo": 1 }, "bar": 2 })JSON")));
+  // The outer evaluation of the nested property is not visible to the
+  // inner unevaluated keyword
+  EXPECT_FALSE(unevaluated_validate(
+      schema, sourcemeta::core::parse_json(
+                  R"JSON({ "nested": { "foo": 1, "baz": 2 } })JSON")));
+  EXPECT_FALSE(unevaluated_validate(
+      schema, sourcemeta::core::parse_json(
+                  R"JSON({ "nested": { "foo": 1 }, "other": 2 })JSON")));
+}
+
+TEST(Evaluator, linked_template_layout) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "properties": {
+      "foo": { "type": "string", "minLength": 2 },
+      "bar": { "items": { "type": "integer" } }
+    },
+    "$defs": { "baz": { "type": "boolean" } },
+    "anyOf": [ { "$ref": "#/$defs/baz" }, { "type": "object" } ]
+  })JSON")};
+
+  const auto compiled_schema{sourcemeta::blaze::compile(
+      schema, sourcemeta::blaze::schema_walker,
+      sourcemeta::blaze::schema_resolver,
+      sourcemeta::blaze::default_schema_compiler,
+      sourcemeta::blaze::Mode::Exhaustive)};
+
+  const auto linked{sourcemeta::blaze::link(compiled_schema)};
+  EXPECT_EQ(linked.dynamic, compiled_schema.dynamic);
+  EXPECT_EQ(linked.track, compiled_schema.track);
+  EXPECT_EQ(linked.labels, compiled_schema.labels);
+  EXPECT_EQ(linked.extra.size(), compiled_schema.extra.size());
+  EXPECT_EQ(linked.targets.size(), compiled_schema.targets.size());
+  EXPECT_EQ(linked.values.size(), linked.instructions.size());
+  EXPECT_FALSE(linked.locations.empty());
+  EXPECT_TRUE(linked.locations.front().empty());
+
+  const auto *begin{linked.instructions.data()};
+  const auto *end{begin + linked.instructions.size()};
+  for (std::size_t index = 0; index < linked.targets.size(); index++) {
+    EXPECT_EQ(linked.targets[index].size(),
+              compiled_schema.targets[index].size());
+    EXPECT_TRUE(linked.targets[index].data() >= begin);
+    EXPECT_TRUE(linked.targets[index].data() + linked.targets[index].size() <=
+                end);
+  }
+
+  for (const auto &instruction : linked.instructions) {
+    EXPECT_TRUE(instruction.children.data() >= begin);
+    EXPECT_TRUE(instruction.children.data() + instruction.children.size() <=
+                end);
+    EXPECT_TRUE(&instruction.value >= linked.values.data());
+    EXPECT_TRUE(&instruction.value <
+                linked.values.data() + linked.values.size());
+  }
+
+  sourcemeta::blaze::Evaluator evaluator;
+  const sourcemeta::core::JSON instance_1{sourcemeta::core::parse_json(
+      R"JSON({ "foo": "xyz", "bar": [ 1, 2, 3 ] })JSON")};
+  EXPECT_TRUE(evaluator.validate(linked, instance_1));
+  const sourcemeta::core::JSON instance_2{sourcemeta::core::parse_json(
+      R"JSON({ "foo": "x", "bar": [ 1, 2, 3 ] })JSON")};
+  EXPECT_FALSE(evaluator.validate(linked, instance_2));
+  const sourcemeta::core::JSON instance_3{sourcemeta::core::parse_json(
+      R"JSON({ "foo": "xyz", "bar": [ 1, "2" ] })JSON")};
+  EXPECT_FALSE(evaluator.validate(linked, instance_3));
+  const sourcemeta::core::JSON instance_4{true};
+  EXPECT_TRUE(evaluator.validate(linked, instance_4));
+  const sourcemeta::core::JSON instance_5{1};
+  EXPECT_FALSE(evaluator.validate(linked, instance_5));
+}
+
+TEST(Evaluator, linked_template_move) {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "items": { "type": "string" }
+  })JSON")};
+
+  const auto compiled_schema{
+      sourcemeta::blaze::compile(schema, sourcemeta::blaze::schema_walker,
+                                 sourcemeta::blaze::schema_resolver,
+                                 sourcemeta::blaze::default_schema_compiler)};
+
+  static_assert(
+      !std::is_copy_constructible_v<sourcemeta::blaze::LinkedTemplate>);
+  static_assert(
+      std::is_move_constructible_v<sourcemeta::blaze::LinkedTemplate>);
+
+  auto linked{sourcemeta::blaze::link(compiled_schema)};
+  const sourcemeta::blaze::LinkedTemplate moved{std::move(linked)};
+
+  sourcemeta::blaze::Evaluator evaluator;
+  const sourcemeta::core::JSON instance_1{
+      sourcemeta::core::parse_json(R"JSON([ "foo", "bar" ])JSON")};
+  EXPECT_TRUE(evaluator.validate(moved, instance_1));
+  const sourcemeta::core::JSON instance_2{
+      sourcemeta::core::parse_json(R"JSON([ "foo", 1 ])JSON")};
+  EXPECT_FALSE(evaluator.validate(moved, instance_2));
+}
+
+static auto batch_test_template() -> sourcemeta::blaze::Template {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "type": "object",
+    "properties": { "id": { "type": "integer" } },
+    "unevaluatedProperties": false
+  })JSON")};
+
+  return sourcemeta::blaze::compile(schema, sourcemeta::blaze::schema_walker,
+                                    sourcemeta::blaze::schema_resolver,
+                                    sourcemeta::blaze::default_schema_compiler);
+}
+
+static auto batch_test_instances(const std::size_t size)
+    -> std::vector<sourcemeta::core::JSON> {
+  std::vector<sourcemeta::core::JSON> result;
+  result.reserve(size);
+  for (std::size_t index = 0; index < size; index++) {
+    auto instance{sourcemeta::core::JSON::make_object()};
+    instance.assign("id", sourcemeta::core::JSON{index});
+    // Every seventh instance is invalid
+    if (index % 7 == 0) {
+      instance.assign("extra", sourcemeta::core::JSON{true});
+    }
+
+    result.push_back(std::move(instance));
+  }
+
+  return result;
+}
+
+TEST(Evaluator, validate_batch_parallel) {
+  const auto schema_template{batch_test_template()};
+  const auto instances{batch_test_instances(10000)};
+  const auto results{std::make_unique<bool[]>(instances.size())};
+  EXPECT_FALSE(sourcemeta::blaze::validate_batch(
+      schema_template, instances, {results.get(), instances.size()}, 4));
+  for (std::size_t index = 0; index < instances.size(); index++) {
+    EXPECT_EQ(results[index], index % 7 != 0);
+  }
+}
+
+TEST(Evaluator, validate_batch_serial) {
+  const auto schema_template{batch_test_template()};
+  const auto instances{batch_test_instances(10)};
+  const auto results{std::make_unique<bool[]>(instances.size())};
+  EXPECT_FALSE(sourcemeta::blaze::validate_batch(
+      schema_template, instances, {results.get(), instances.size()}, 1));
+  for (std::size_t index = 0; index < instances.size(); index++) {
+    EXPECT_EQ(results[index], index % 7 != 0);
+  }
+}
+
+TEST(Evaluator, validate_batch_all_valid) {
+  const auto schema_template{batch_test_template()};
+  std::vector<sourcemeta::core::JSON> instances;
+  for (std::size_t index = 0; index < 1000; index++) {
+    auto instance{sourcemeta::core::JSON::make_object()};
+    instance.assign("id", sourcemeta::core::JSON{index});
+    instances.push_back(std::move(instance));
+  }
+
+  const auto results{std::make_unique<bool[]>(instances.size())};
+  EXPECT_TRUE(sourcemeta::blaze::validate_batch(
+      schema_template, instances, {results.get(), instances.size()}));
+  for (std::size_t index = 0; index < instances.size(); index++) {
+    EXPECT_TRUE(results[index]);
+  }
+}
+
+TEST(Evaluator, validate_batch_empty) {
+  const auto schema_template{batch_test_template()};
+  const std::vector<sourcemeta::core::JSON> instances;
+  EXPECT_TRUE(
+      sourcemeta::blaze::validate_batch(schema_template, instances, {}));
+}
+
+TEST(Evaluator, validate_batch_linked) {
+  const auto linked{sourcemeta::blaze::link(batch_test_template())};
+  const auto instances{batch_test_instances(5000)};
+  const auto results{std::make_unique<bool[]>(instances.size())};
+  EXPECT_FALSE(sourcemeta::blaze::validate_batch(
+      linked, instances, {results.get(), instances.size()}, 3));
+  for (std::size_t index = 0; index < instances.size(); index++) {
+    EXPECT_EQ(results[index], index % 7 != 0);
+  }
+}
+
+TEST(Evaluator, validate_batch_results_size_mismatch) {
+  const auto schema_template{batch_test_template()};
+  const auto instances{batch_test_instances(10)};
+  const auto results{std::make_unique<bool[]>(instances.size())};
+  EXPECT_THROW(sourcemeta::blaze::validate_batch(
+                   schema_template, instances, {results.get(), 9}),
+               std::invalid_argument);
+  sourcemeta::blaze::BatchValidator pool{2};
+  EXPECT_THROW(pool.validate(schema_template, instances, {results.get(), 9}),
+               std::invalid_argument);
+}
+
+TEST(Evaluator, batch_validator_reuse) {
+  const auto schema_template{batch_test_template()};
+  const auto linked{sourcemeta::blaze::link(schema_template)};
+  sourcemeta::blaze::BatchValidator pool{4};
+  EXPECT_EQ(pool.parallelism(), 4);
+  // Alternate between batches that wake the workers and batches that run on
+  // the calling thread
+  for (const auto size : {5000, 10, 1000, 0, 3000}) {
+    const auto instances{batch_test_instances(static_cast<std::size_t>(size))};
+    const auto results{std::make_unique<bool[]>(instances.size())};
+    EXPECT_EQ(pool.validate(schema_template, instances,
+                            {results.get(), instances.size()}),
+              instances.empty());
+    for (std::size_t index = 0; index < instances.size(); index++) {
+      EXPECT_EQ(results[index], index % 7 != 0);
+    }
+
+    EXPECT_EQ(
+        pool.validate(linked, instances, {results.get(), instances.size()}),
+        instances.empty());
+  }
+}
+
+TEST(Evaluator, batch_validator_move) {
+  const auto schema_template{batch_test_template()};
+  sourcemeta::blaze::BatchValidator pool{3};
+  auto moved{std::move(pool)};
+  const auto instances{batch_test_instances(1000)};
+  const auto results{std::make_unique<bool[]>(instances.size())};
+  EXPECT_FALSE(moved.validate(schema_template, instances,
+                              {results.get(), instances.size()}));
+}
+
+static auto deep_test_template() -> sourcemeta::blaze::Template {
+  const sourcemeta::core::JSON schema{sourcemeta::core::parse_json(R"JSON({
+    "$schema": "https://json-schema.org/draft/2020-12/schema",
+    "type": [ "array", "integer" ],
+    "items": { "$ref": "#" }
+  })JSON")};
+
+  return sourcemeta::blaze::compile(schema, sourcemeta::blaze::schema_walker,
+                                    sourcemeta::blaze::schema_resolver,
+                                    sourcemeta::blaze::default_schema_compiler);
+}
+
+static auto deep_test_instance(const std::size_t depth,
+                               sourcemeta::core::JSON leaf)
+    -> sourcemeta::core::JSON {
+  auto result{std::move(leaf)};
+  for (std::size_t level = 0; level < depth; level++) {
+    auto wrapper{sourcemeta::core::JSON::make_array()};
+    wrapper.push_back(std::move(result));
+    result = std::move(wrapper);
+  }
+
+  return result;
+}
+
+TEST(Evaluator, depth_limit_native_stack) {
+  const auto schema_template{deep_test_template()};
+  const auto instance{deep_test_instance(500, sourcemeta::core::JSON{1})};
+  sourcemeta::blaze::Evaluator evaluator;
+  try {
+    evaluator.validate(schema_template, instance);
+    FAIL();
+  } catch (const sourcemeta::blaze::EvaluationError &error) {
+    EXPECT_STREQ(error.what(), "The evaluation path depth limit was reached "
+                               "likely due to infinite recursion");
+  } catch (...) {
+    FAIL();
+  }
+}
+
+TEST(Evaluator, validate_batch_exception) {
+  const auto schema_template{deep_test_template()};
+  std::vector<sourcemeta::core::JSON> instances;
+  for (std::size_t index = 0; index < 1000; index++) {
+    instances.push_back(
+        deep_test_instance(index == 700 ? 500 : 2, sourcemeta::core::JSON{1}));
+  }
+
+  const auto results{std::make_unique<bool[]>(instances.size())};
+  EXPECT_THROW(
+      sourcemeta::blaze::validate_batch(schema_template, instances,
+                                        {results.get(), instances.size()}, 4),
+      sourcemeta::blaze::EvaluationError);
+
+  // The pool remains usable after a batch fails
+  sourcemeta::blaze::BatchValidator pool{4};
+  EXPECT_THROW(pool.validate(schema_template, instances,
+                             {results.get(), instances.size()}),
+               sourcemeta::blaze::EvaluationError);
+  instances[700] = deep_test_instance(2, sourcemeta::core::JSON{1});
+  EXPECT_TRUE(pool.validate(schema_template, instances,
+                            {results.get(), instances.size()}));
+}
+
+TEST(Evaluator, owned_stack_shallow) {
+  const auto schema_template{deep_test_template()};
+  sourcemeta::blaze::Evaluator evaluator{1024 * 1024};
+  const auto instance_1{deep_test_instance(10, sourcemeta::core::JSON{1})};
+  EXPECT_TRUE(evaluator.validate(schema_template, instance_1));
+  const auto instance_2{deep_test_instance(10, sourcemeta::core::JSON{"x"})};
+  EXPECT_FALSE(evaluator.validate(schema_template, instance_2));
+  EXPECT_TRUE(
+      evaluator.validate(sourcemeta::blaze::link(schema_template), instance_1));
+
+  std::size_t steps{0};
+  EXPECT_TRUE(evaluator.validate(
+      schema_template, instance_1,
+      [&steps](const auto, const auto, const auto &, const auto &,
+               const auto &, const auto &, const auto &) { steps += 1; }));
+  EXPECT_GT(steps, 0);
+}
+
+TEST(Evaluator, owned_stack_maximum_depth) {
+  const auto schema_template{deep_test_template()};
+  const auto instance{deep_test_instance(500, sourcemeta::core::JSON{1})};
+  sourcemeta::blaze::Evaluator evaluator{8 * 1024 * 1024, 100};
+  try {
+    evaluator.validate(schema_template, instance);
+    FAIL();
+  } catch (const sourcemeta::blaze::EvaluationError &error) {
+    EXPECT_STREQ(error.what(), "The evaluation path depth limit was reached "
+                               "likely due to infinite recursion");
+  } catch (...) {
+    FAIL();
+  }
+}
+
+TEST(Evaluator, owned_stack_too_small) {
+  EXPECT_THROW(sourcemeta::blaze::Evaluator{128 * 1024},
+               std::invalid_argument);
+}
+
+TEST(Evaluator, owned_stack_copy) {
+  static_assert(std::is_copy_constructible_v<sourcemeta::blaze::Evaluator>);
+  static_assert(std::is_copy_assignable_v<sourcemeta::blaze::Evaluator>);
+  const auto schema_template{deep_test_template()};
+  const auto instance{deep_test_instance(10, sourcemeta::core::JSON{1})};
+  const sourcemeta::blaze::Evaluator evaluator{1024 * 1024};
+  auto copy{evaluator};
+  EXPECT_TRUE(copy.validate(schema_template, instance));
+  sourcemeta::blaze::Evaluator native;
+  native = copy;
+  EXPECT_TRUE(native.validate(schema_template, instance));
+}
+
+// Owned stacks are only supported where we can switch stacks
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+
+TEST(Evaluator, owned_stack_deep) {
+  const auto schema_template{deep_test_template()};
+  const auto instance_1{deep_test_instance(5000, sourcemeta::core::JSON{1})};
+  const auto instance_2{deep_test_instance(5000, sourcemeta::core::JSON{"x"})};
+  sourcemeta::blaze::Evaluator evaluator{64 * 1024 * 1024};
+  // The same stack is reused across evaluations
+  EXPECT_TRUE(evaluator.validate(schema_template, instance_1));
+  EXPECT_FALSE(evaluator.validate(schema_template, instance_2));
+  EXPECT_TRUE(evaluator.validate(schema_template, instance_1));
+}
+
+TEST(Evaluator, owned_stack_copy_deep) {
+  const auto schema_template{deep_test_template()};
+  const auto instance{deep_test_instance(5000, sourcemeta::core::JSON{1})};
+  const sourcemeta::blaze::Evaluator evaluator{64 * 1024 * 1024};
+  // The copy evaluates on a stack of its own
+  auto copy{evaluator};
+  EXPECT_TRUE(copy.validate(schema_template, instance));
+}
+
+TEST(Evaluator, owned_stack_exhausted) {
+  const auto schema_template{deep_test_template()};
+  const auto instance{deep_test_instance(20000, sourcemeta::core::JSON{1})};
+  sourcemeta::blaze::Evaluator evaluator{1024 * 1024};
+  try {
+    evaluator.validate(schema_template, instance);
+    FAIL();
+  } catch (const sourcemeta::blaze::EvaluationError &error) {
+    EXPECT_STREQ(error.what(), "The evaluation stack was exhausted");
+  } catch (...) {
+    FAIL();
+  }
+}
+
+#endif
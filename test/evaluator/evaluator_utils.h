@@ -41,7 +41,10 @@ inline auto FIRST_PROPERTY_IS(const sourcemeta::core::JSON &document,
         }                                                                      \
       })};                                                                     \
   EXPECT_EQ(trace_pre.size(), count);                                          \
-  EXPECT_EQ(trace_post.size(), count);
+  EXPECT_EQ(trace_post.size(), count);                                         \
+  EXPECT_EQ(evaluator.validate(sourcemeta::blaze::link(schema_template),       \
+                               instance),                                      \
+            result);
 
 #define __ASSERT_TEMPLATE_JSON_SERIALISATION(compiled_schema)                  \
   {                                                                            \
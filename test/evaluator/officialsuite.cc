@@ -4,7 +4,9 @@
 #include <cctype>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <set>
@@ -17,6 +19,7 @@
 #include <sourcemeta/blaze/evaluator.h>
 
 #include <sourcemeta/blaze/foundation.h>
+#include <sourcemeta/core/io.h>
 #include <sourcemeta/core/json.h>
 
 static auto test_resolver(std::string_view identifier)
@@ -224,11 +227,13 @@ static auto slugify(const std::string &input, std::ostream &output) -> void {
 
 class OfficialTest : public testing::Test {
 public:
-  explicit OfficialTest(bool test_valid,
-                        sourcemeta::blaze::Template test_schema,
-                        sourcemeta::core::JSON test_instance)
+  explicit OfficialTest(
+      bool test_valid, sourcemeta::blaze::Template test_schema,
+      std::shared_ptr<const sourcemeta::blaze::LinkedTemplate> test_binary,
+      sourcemeta::core::JSON test_instance)
       : valid{test_valid}, schema{std::move(test_schema)},
-        instance{std::move(test_instance)} {}
+        linked{sourcemeta::blaze::link(this->schema)},
+        binary{std::move(test_binary)}, instance{std::move(test_instance)} {}
 
   auto TestBody() -> void override {
     const auto result{this->evaluator.validate(this->schema, this->instance)};
@@ -237,11 +242,18 @@ public:
     } else {
       EXPECT_FALSE(result);
     }
+
+    EXPECT_EQ(this->evaluator.validate(this->linked, this->instance), result);
+    // The binary form of the template must load and evaluate the same
+    ASSERT_TRUE(this->binary);
+    EXPECT_EQ(this->evaluator.validate(*this->binary, this->instance), result);
   }
 
 private:
   const bool valid;
   const sourcemeta::blaze::Template schema;
+  const sourcemeta::blaze::LinkedTemplate linked;
+  const std::shared_ptr<const sourcemeta::blaze::LinkedTemplate> binary;
   const sourcemeta::core::JSON instance;
   sourcemeta::blaze::Evaluator evaluator;
 };
@@ -287,6 +299,21 @@ static auto register_tests(
             sourcemeta::blaze::default_schema_compiler, mode, default_dialect,
             "", "", tweaks)};
 
+        const sourcemeta::core::TemporaryDirectory directory{
+            std::filesystem::temp_directory_path(), ".blaze-official-"};
+        const auto binary_path{directory.path() / "template.bin"};
+        {
+          std::ofstream stream{binary_path, std::ios::binary};
+          sourcemeta::blaze::to_binary(schema_template, stream);
+        }
+
+        auto binary_template{sourcemeta::blaze::from_binary(binary_path)};
+        const auto binary{
+            binary_template.has_value()
+                ? std::make_shared<const sourcemeta::blaze::LinkedTemplate>(
+                      std::move(binary_template).value())
+                : nullptr};
+
         for (const auto &test_case : test.at("tests").as_array()) {
           std::ostringstream title;
           switch (mode) {
@@ -319,7 +346,8 @@ static auto register_tests(
           testing::RegisterTest(
               suite_name.c_str(), title.str().c_str(), nullptr, nullptr,
               __FILE__, __LINE__, [=]() -> OfficialTest * {
-                return new OfficialTest(valid, schema_template, instance);
+                return new OfficialTest(valid, schema_template, binary,
+                                        instance);
               });
         }
       }